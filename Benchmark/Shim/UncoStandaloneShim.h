@@ -0,0 +1,452 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+// エンジン外でコルーチンの基盤をビルドする為の最小限の代替を記述する
+//
+// UNCO_STANDALONEの時にUncoCoreMinimal.hから読み込まれる。
+// 基盤のコードが使用する範囲だけを、エンジンと同じ名前・同じ振る舞いで用意する。
+// - UObject/FWeakObjectPtr: オブジェクト配列のインデックスとシリアル番号による生存判定
+// - TArray: 要素をビット単位で再配置する連続配列
+// - FMath/FPlatformTime: 使用している関数のみ
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+////////////////////////////////////////////////////////
+// 型・マクロ
+
+using int32  = std::int32_t;
+using uint32 = std::uint32_t;
+using int64  = std::int64_t;
+using uint64 = std::uint64_t;
+using uint8  = std::uint8_t;
+
+#define FORCEINLINE inline __attribute__((always_inline))
+#define UNREALCOROUTINE_API
+#define INDEX_NONE (-1)
+#define check(Expr) assert(Expr)
+
+// 統計・ログはエンジン外では何もしない
+#define DECLARE_STATS_GROUP(...)
+#define DECLARE_LOG_CATEGORY_EXTERN(...)
+#define DECLARE_CYCLE_STAT(...)
+#define SCOPE_CYCLE_COUNTER(...)
+
+template<class T>
+FORCEINLINE std::remove_reference_t<T>&& MoveTemp(T&& Value)
+{
+	return static_cast<std::remove_reference_t<T>&&>(Value);
+}
+
+template<class T>
+FORCEINLINE void Swap(T& A, T& B)
+{
+	T Temp = MoveTemp(A);
+	A      = MoveTemp(B);
+	B      = MoveTemp(Temp);
+}
+
+////////////////////////////////////////////////////////
+// FMath
+
+struct FMath
+{
+	template<class T>
+	static constexpr T Max(T A, T B)
+	{
+		return A < B ? B : A;
+	}
+
+	template<class T>
+	static constexpr T Min(T A, T B)
+	{
+		return A < B ? A : B;
+	}
+
+	template<class T>
+	static constexpr T Clamp(T X, T Min, T Max)
+	{
+		return X < Min ? Min : (X < Max ? X : Max);
+	}
+
+	static int32 CeilToInt(float F)
+	{
+		return static_cast<int32>(std::ceil(F));
+	}
+
+	static int32 FloorToInt(float F)
+	{
+		return static_cast<int32>(std::floor(F));
+	}
+};
+
+////////////////////////////////////////////////////////
+// FPlatformTime
+
+// 1サイクルを1nsとして扱う
+struct FPlatformTime
+{
+	static FORCEINLINE uint64 Cycles64()
+	{
+		return static_cast<uint64>(
+		    std::chrono::duration_cast<std::chrono::nanoseconds>(
+		        std::chrono::steady_clock::now().time_since_epoch())
+		        .count());
+	}
+
+	static FORCEINLINE double ToSeconds64(uint64 Cycles)
+	{
+		return static_cast<double>(Cycles) * 1e-9;
+	}
+
+	static FORCEINLINE double ToMilliseconds64(uint64 Cycles)
+	{
+		return static_cast<double>(Cycles) * 1e-6;
+	}
+};
+
+////////////////////////////////////////////////////////
+// TArray
+
+/**
+ * @brief 連続配列
+ *
+ * エンジンのTArrayと同じく要素をビット単位で再配置する為、ムーブ出来ない型も格納出来る。
+ */
+template<class T>
+class TArray
+{
+public:
+	TArray() = default;
+	~TArray()
+	{
+		Empty();
+	}
+
+	TArray(TArray&& Other) noexcept
+	    : Data(std::exchange(Other.Data, nullptr))
+	    , ArrayNum(std::exchange(Other.ArrayNum, 0))
+	    , ArrayMax(std::exchange(Other.ArrayMax, 0))
+	{
+	}
+
+	TArray& operator=(TArray&& Other) noexcept
+	{
+		if ( this != &Other )
+		{
+			Empty();
+			Data     = std::exchange(Other.Data, nullptr);
+			ArrayNum = std::exchange(Other.ArrayNum, 0);
+			ArrayMax = std::exchange(Other.ArrayMax, 0);
+		}
+		return *this;
+	}
+
+	TArray(const TArray&) = delete;
+	void operator=(const TArray&) = delete;
+
+	int32 Num() const
+	{
+		return ArrayNum;
+	}
+
+	bool IsValidIndex(int32 Index) const
+	{
+		return Index >= 0 && Index < ArrayNum;
+	}
+
+	T* GetData() const
+	{
+		return Data;
+	}
+
+	T& operator[](int32 Index) const
+	{
+		check(IsValidIndex(Index));
+		return Data[Index];
+	}
+
+	T& Last() const
+	{
+		return (*this)[ArrayNum - 1];
+	}
+
+	T* begin() const
+	{
+		return Data;
+	}
+
+	T* end() const
+	{
+		return Data + ArrayNum;
+	}
+
+	void Reserve(int32 Number)
+	{
+		if ( Number > ArrayMax )
+		{
+			ResizeTo(Number);
+		}
+	}
+
+	template<class... ArgsType>
+	int32 Emplace(ArgsType&&... Args)
+	{
+		if ( ArrayNum == ArrayMax )
+		{
+			ResizeTo(ArrayMax > 0 ? ArrayMax * 2 : 4);
+		}
+		new (Data + ArrayNum) T(std::forward<ArgsType>(Args)...);
+		return ArrayNum++;
+	}
+
+	int32 Add(const T& Item)
+	{
+		return Emplace(Item);
+	}
+
+	int32 Add(T&& Item)
+	{
+		return Emplace(MoveTemp(Item));
+	}
+
+	// 要素を破棄する(確保済みの領域は残す)
+	void Reset()
+	{
+		DestructRange(0, ArrayNum);
+		ArrayNum = 0;
+	}
+
+	// 要素を破棄して領域も解放する
+	void Empty()
+	{
+		Reset();
+		std::free(Data);
+		Data     = nullptr;
+		ArrayMax = 0;
+	}
+
+	// 条件を満たす要素を順序を保って取り除く
+	template<class PredicateType>
+	int32 RemoveAll(const PredicateType& Predicate)
+	{
+		const int32 OldNum     = ArrayNum;
+		int32       WriteIndex = 0;
+		for ( int32 ReadIndex = 0; ReadIndex < OldNum; ++ReadIndex )
+		{
+			if ( Predicate(Data[ReadIndex]) )
+			{
+				Data[ReadIndex].~T();
+			}
+			else
+			{
+				Relocate(WriteIndex++, ReadIndex);
+			}
+		}
+		ArrayNum = WriteIndex;
+		return OldNum - WriteIndex;
+	}
+
+	// 条件を満たす要素を末尾の要素で埋めて取り除く(順序は保たない)
+	template<class PredicateType>
+	int32 RemoveAllSwap(const PredicateType& Predicate)
+	{
+		const int32 OldNum = ArrayNum;
+		for ( int32 Index = 0; Index < ArrayNum; )
+		{
+			if ( Predicate(Data[Index]) )
+			{
+				Data[Index].~T();
+				Relocate(Index, --ArrayNum);
+			}
+			else
+			{
+				++Index;
+			}
+		}
+		return OldNum - ArrayNum;
+	}
+
+	void Sort()
+	{
+		std::sort(begin(), end());
+	}
+
+private:
+	void ResizeTo(int32 NewMax)
+	{
+		// ビット単位で再配置する
+		Data     = static_cast<T*>(std::realloc(static_cast<void*>(Data), sizeof(T) * NewMax));
+		ArrayMax = NewMax;
+		if ( Data == nullptr )
+		{
+			std::abort();
+		}
+	}
+
+	void Relocate(int32 To, int32 From)
+	{
+		if ( To != From )
+		{
+			std::memcpy(static_cast<void*>(Data + To), static_cast<const void*>(Data + From), sizeof(T));
+		}
+	}
+
+	void DestructRange(int32 Index, int32 Count)
+	{
+		for ( int32 Offset = 0; Offset < Count; ++Offset )
+		{
+			Data[Index + Offset].~T();
+		}
+	}
+
+	T*    Data     = nullptr;
+	int32 ArrayNum = 0;
+	int32 ArrayMax = 0;
+};
+
+////////////////////////////////////////////////////////
+// UObject
+
+class UObject;
+
+/**
+ * @brief オブジェクト配列
+ *
+ * エンジンのGUObjectArrayと同じく、生存しているオブジェクトをインデックスで引き、
+ * 破棄されたスロットはシリアル番号を変えて再利用する。
+ */
+class FUObjectArray
+{
+public:
+	struct FUObjectItem
+	{
+		UObject* Object       = nullptr;
+		int32    SerialNumber = 0;
+	};
+
+	int32 AllocateIndex(UObject* Object)
+	{
+		int32 Index;
+		if ( !FreeIndices.empty() )
+		{
+			Index = FreeIndices.back();
+			FreeIndices.pop_back();
+		}
+		else
+		{
+			Index = static_cast<int32>(Items.size());
+			Items.emplace_back();
+		}
+		Items[Index].Object       = Object;
+		Items[Index].SerialNumber = ++SerialCounter;
+		return Index;
+	}
+
+	void FreeIndex(int32 Index)
+	{
+		Items[Index].Object       = nullptr;
+		Items[Index].SerialNumber = 0;
+		FreeIndices.push_back(Index);
+	}
+
+	FORCEINLINE const FUObjectItem* IndexToObject(int32 Index) const
+	{
+		return Index >= 0 && Index < static_cast<int32>(Items.size()) ? &Items[Index] : nullptr;
+	}
+
+private:
+	std::vector<FUObjectItem> Items;
+	std::vector<int32>        FreeIndices;
+	int32                     SerialCounter = 0;
+};
+
+inline FUObjectArray GUObjectArray;
+
+/**
+ * @brief UObjectの代替
+ *
+ * 生成時にオブジェクト配列に登録され、破棄(delete)で登録が外れる。
+ */
+class UObject
+{
+public:
+	UObject()
+	    : InternalIndex(GUObjectArray.AllocateIndex(this))
+	{
+	}
+
+	virtual ~UObject()
+	{
+		GUObjectArray.FreeIndex(InternalIndex);
+	}
+
+	UObject(const UObject&) = delete;
+	void operator=(const UObject&) = delete;
+
+	int32 GetUniqueID() const
+	{
+		return InternalIndex;
+	}
+
+private:
+	int32 InternalIndex;
+};
+
+FORCEINLINE bool IsValid(const UObject* Test)
+{
+	return Test != nullptr;
+}
+
+/**
+ * @brief オブジェクトの弱参照
+ *
+ * エンジンと同じくインデックスとシリアル番号を保持し、参照時にオブジェクト配列と照合する。
+ */
+struct FWeakObjectPtr
+{
+	FWeakObjectPtr() = default;
+
+	FWeakObjectPtr(const UObject* Object)
+	{
+		*this = Object;
+	}
+
+	FWeakObjectPtr& operator=(const UObject* Object)
+	{
+		if ( Object != nullptr )
+		{
+			ObjectIndex        = Object->GetUniqueID();
+			ObjectSerialNumber = GUObjectArray.IndexToObject(ObjectIndex)->SerialNumber;
+		}
+		else
+		{
+			ObjectIndex        = INDEX_NONE;
+			ObjectSerialNumber = 0;
+		}
+		return *this;
+	}
+
+	FORCEINLINE bool IsValid() const
+	{
+		const FUObjectArray::FUObjectItem* Item = GUObjectArray.IndexToObject(ObjectIndex);
+		return Item != nullptr && ObjectSerialNumber != 0 && Item->SerialNumber == ObjectSerialNumber;
+	}
+
+	FORCEINLINE UObject* Get() const
+	{
+		return IsValid() ? GUObjectArray.IndexToObject(ObjectIndex)->Object : nullptr;
+	}
+
+private:
+	int32 ObjectIndex        = INDEX_NONE;
+	int32 ObjectSerialNumber = 0;
+};
@@ -0,0 +1,293 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+// コルーチンの基盤処理をエンジン外で計測する
+//
+// UncoBenchmark [Ops=10000] [Samples=20] [Cpu=0]
+// 各項目をOps回の操作でSamples回計測し、1操作あたりの時間(ns)の最小・P50・P90・P99・最大を出力する。
+// Cpuに負の値を指定した場合はCPUを固定しない。
+
+#include "UncoDistributedFrame.h"
+#include "UncoFrameBudget.h"
+#include "UncoObjectGenerator.h"
+#include "UncoObjectTask.h"
+#include "UncoTaskRegistry.h"
+#include <cstdio>
+#include <cstdlib>
+#if defined(__linux__)
+	#include <sched.h>
+#endif
+
+namespace unco::details
+{
+
+	namespace
+	{
+		// 計測中のタスクの登録先
+		// エンジンのスケジューラーの代わりに全てのホストのタスクを所有する
+		FTaskRegistry* GBenchmarkRegistry = nullptr;
+
+		// 手動で再開するまでコルーチンを待機させる
+		struct FBenchmarkGate
+		{
+			TArray<std::coroutine_handle<>> Waiting;
+			TArray<std::coroutine_handle<>> Resuming;
+			bool                            bStop = false;
+
+			explicit FBenchmarkGate(int32 NumCoroutines)
+			{
+				Waiting.Reserve(NumCoroutines);
+				Resuming.Reserve(NumCoroutines);
+			}
+
+			// 待機中のコルーチンを1回ずつ再開する
+			// 再開したコルーチンは再びWaitingに積まれる
+			void ResumeAll()
+			{
+				Swap(Waiting, Resuming);
+				for ( std::coroutine_handle<> Coroutine : Resuming )
+				{
+					Coroutine.resume();
+				}
+				Resuming.Reset();
+			}
+		};
+
+		struct FBenchmarkGateAwaiter
+		{
+			FBenchmarkGate& Gate;
+
+			constexpr bool await_ready() const noexcept
+			{
+				return false;
+			}
+			void await_suspend(std::coroutine_handle<> coroutine)
+			{
+				Gate.Waiting.Add(coroutine);
+			}
+			constexpr void await_resume() const noexcept {}
+		};
+
+		// 待機せずに終了するタスク
+		FObjectTask ImmediateTask(UObject* Host)
+		{
+			co_return;
+		}
+
+		// ゲートが止められるまで待機を繰り返すタスク
+		FObjectTask GateLoopTask(UObject* Host, FBenchmarkGate* Gate)
+		{
+			while ( !Gate->bStop )
+			{
+				co_await FBenchmarkGateAwaiter{*Gate};
+			}
+		}
+
+		// 終わらないジェネレーター
+		FObjectGenerator CountingGenerator(UObject* Host)
+		{
+			while ( true )
+			{
+				co_yield 1;
+			}
+		}
+
+		// 1項目分の計測結果
+		struct FBenchmarkCase
+		{
+			const char*    Name;
+			TArray<double> NsPerOp = {};
+		};
+
+		enum EBenchmarkCase : int32
+		{
+			ImmediateTaskCase,
+			SpawnSuspendedCase,
+			ResumeCase,
+			FinishCase,
+			CollectCase,
+			HostSweepCase,
+			GeneratorStepCase,
+			DistributedFrameCase,
+			NumBenchmarkCases,
+		};
+
+		double Percentile(const TArray<double>& Sorted, double Ratio)
+		{
+			const int32 Index = FMath::Clamp(FMath::CeilToInt(Ratio * Sorted.Num()) - 1, 0, Sorted.Num() - 1);
+			return Sorted[Index];
+		}
+
+		// 計測を行うスレッドを1つのCPUに固定してスケジューリングによるばらつきを抑える
+		void PinToCpu(int32 Cpu)
+		{
+#if defined(__linux__)
+			if ( Cpu < 0 )
+			{
+				return;
+			}
+			cpu_set_t Set;
+			CPU_ZERO(&Set);
+			CPU_SET(Cpu, &Set);
+			if ( sched_setaffinity(0, sizeof(Set), &Set) != 0 )
+			{
+				std::fprintf(stderr, "unco benchmark: failed to pin to cpu %d\n", Cpu);
+			}
+#endif
+		}
+
+		void RunSample(int32 NumOps, FBenchmarkCase* Cases)
+		{
+			FTaskRegistry Registry;
+			GBenchmarkRegistry = &Registry;
+
+			UObject* Host = new UObject();
+
+			uint64 StartCycles = 0;
+			auto   Begin       = [&StartCycles]()
+			{
+				StartCycles = FPlatformTime::Cycles64();
+			};
+			auto End = [&StartCycles, Cases, NumOps](EBenchmarkCase Case)
+			{
+				const double Ns = FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles) * 1e9;
+				if ( Cases != nullptr )
+				{
+					Cases[Case].NsPerOp.Add(Ns / NumOps);
+				}
+			};
+
+			// フレームの確保・開始・終了・破棄
+			Begin();
+			for ( int32 Index = 0; Index < NumOps; ++Index )
+			{
+				ImmediateTask(Host);
+			}
+			End(ImmediateTaskCase);
+
+			// フレームの確保・開始・サスペンド・登録先への登録
+			FBenchmarkGate Gate(NumOps);
+			Begin();
+			for ( int32 Index = 0; Index < NumOps; ++Index )
+			{
+				GateLoopTask(Host, &Gate);
+			}
+			End(SpawnSuspendedCase);
+
+			// 再開から次のサスペンドまで
+			Begin();
+			Gate.ResumeAll();
+			End(ResumeCase);
+
+			// 再開から終了・登録先への終了通知まで
+			Gate.bStop = true;
+			Begin();
+			Gate.ResumeAll();
+			End(FinishCase);
+
+			// 終了したタスクのまとめての破棄
+			Begin();
+			Registry.Collect(false);
+			End(CollectCase);
+
+			// 呼び出し元オブジェクトが破棄されたタスクの生存判定と破棄
+			{
+				UObject*       SweptHost = new UObject();
+				FBenchmarkGate SweptGate(NumOps);
+				for ( int32 Index = 0; Index < NumOps; ++Index )
+				{
+					GateLoopTask(SweptHost, &SweptGate);
+				}
+				delete SweptHost;
+
+				Begin();
+				Registry.Collect(true);
+				End(HostSweepCase);
+			}
+
+			// ジェネレーターの1ステップ
+			{
+				FObjectGenerator Generator = CountingGenerator(Host);
+				Begin();
+				for ( int32 Index = 0; Index < NumOps; ++Index )
+				{
+					Generator.MoveNext();
+				}
+				End(GeneratorStepCase);
+			}
+
+			// 分散フレーム実行のジェネレーター毎の1ステップ
+			{
+				FDistributedFrameList DistributedFrames;
+				for ( int32 Index = 0; Index < NumOps; ++Index )
+				{
+					DistributedFrames.Add(CountingGenerator(Host), FFrameBudget::Items(1), false);
+				}
+				Begin();
+				DistributedFrames.Run(
+				    [](FDistributedFrameInfo& FrameInfo)
+				    {
+					    StepDistributedFrame(FrameInfo, FrameInfo.Budget);
+				    });
+				End(DistributedFrameCase);
+			}
+
+			delete Host;
+			Registry.Reset();
+			GBenchmarkRegistry = nullptr;
+		}
+
+		void Run(int32 NumOps, int32 NumSamples)
+		{
+			FBenchmarkCase Cases[NumBenchmarkCases] = {
+			    {"ImmediateTask"},
+			    {"SpawnSuspended"},
+			    {"Resume"},
+			    {"Finish"},
+			    {"Collect"},
+			    {"HostSweep"},
+			    {"GeneratorStep"},
+			    {"DistributedFrame"},
+			};
+			for ( FBenchmarkCase& Case : Cases )
+			{
+				Case.NsPerOp.Reserve(NumSamples);
+			}
+
+			// 最初の1回は暖機として捨てる
+			for ( int32 Sample = -1; Sample < NumSamples; ++Sample )
+			{
+				RunSample(NumOps, Sample >= 0 ? Cases : nullptr);
+			}
+
+			std::printf("unco benchmark: %d ops x %d samples (ns/op)\n", NumOps, NumSamples);
+			std::printf("%-18s %10s %10s %10s %10s %10s\n", "Case", "Min", "P50", "P90", "P99", "Max");
+			for ( FBenchmarkCase& Case : Cases )
+			{
+				Case.NsPerOp.Sort();
+				std::printf("%-18s %10.1f %10.1f %10.1f %10.1f %10.1f\n",
+				            Case.Name,
+				            Case.NsPerOp[0],
+				            Percentile(Case.NsPerOp, 0.5),
+				            Percentile(Case.NsPerOp, 0.9),
+				            Percentile(Case.NsPerOp, 0.99),
+				            Case.NsPerOp.Last());
+			}
+		}
+	} // namespace
+
+	FTaskRegistry* FindTaskRegistry(const UObject* Host)
+	{
+		return GBenchmarkRegistry;
+	}
+
+} // namespace unco::details
+
+int main(int argc, char** argv)
+{
+	const int32 NumOps     = argc > 1 ? FMath::Max(std::atoi(argv[1]), 1) : 10000;
+	const int32 NumSamples = argc > 2 ? FMath::Max(std::atoi(argv[2]), 1) : 20;
+	const int32 Cpu        = argc > 3 ? std::atoi(argv[3]) : 0;
+
+	unco::details::PinToCpu(Cpu);
+	unco::details::Run(NumOps, NumSamples);
+	return 0;
+}
@@ -0,0 +1,93 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "UObject/SoftObjectPath.h"
+#include "UncoObjectTask.h"
+#include "UncoSync.h"
+#include "UncoRunCoroutineCommandlet.generated.h"
+
+/**
+ * @brief ゲームワールドや描画無しでコルーチンを実行するコマンドレット
+ *
+ * ワールドを持たずにエンジンのスケジューラーでタスクを実行し、独自のループでコアティッカー・非同期ロード・
+ * ゲームスレッドに投げられたタスクを更新する。ルートのタスクが終了した時点で終了する。
+ * デフォルトではGatherItemsで列挙したアイテムを最大MaxConcurrency個ずつ並行してProcessItemで処理する。
+ * 派生クラスでGatherItems/ProcessItemを実装するか、RunCoroutine自体を置き換えて使用する。
+ *
+ * -run=UncoRunCoroutine [-Assets=Path1,Path2] [-AssetList=File] [-MaxConcurrency=N] [-ReportInterval=Sec] [-GCInterval=N]
+ */
+UCLASS()
+class UNREALCOROUTINE_API UUncoRunCoroutineCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UUncoRunCoroutineCommandlet();
+
+	// Begin UCommandlet
+	virtual int32 Main(const FString& Params) override;
+	// End UCommandlet
+
+protected:
+	/**
+	 * @brief 実行するコルーチン
+	 *
+	 * デフォルトではアイテムを列挙して同時実行数を制限しながら処理する。
+	 * @param Params コマンドライン引数
+	 */
+	virtual unco::FObjectTask RunCoroutine(FString Params);
+
+	/**
+	 * @brief 処理するアイテムを列挙する
+	 *
+	 * デフォルトでは-Assets=(カンマ区切り)と-AssetList=(1行1パスのファイル)からアセットパスを読み取る。
+	 * @param Params コマンドライン引数
+	 * @param OutItems 処理するアイテム
+	 */
+	virtual void GatherItems(const FString& Params, TArray<FSoftObjectPath>& OutItems);
+
+	/**
+	 * @brief アイテムを1つ処理する
+	 *
+	 * デフォルトではアセットを非同期ロードするだけ。
+	 * @param Item 処理するアイテム
+	 */
+	virtual unco::FObjectTask ProcessItem(FSoftObjectPath Item);
+
+	// 処理したアイテム数を加算する(スループットの集計に使用する)
+	void AddProcessedItems(int32 Num = 1)
+	{
+		NumProcessed += Num;
+	}
+
+	// 失敗したアイテム数を加算する
+	void AddFailedItems(int32 Num = 1)
+	{
+		NumFailed += Num;
+	}
+
+	// 同時に処理するアイテム数の上限
+	int32 MaxConcurrency = 16;
+	// 進捗を出力する間隔(秒)
+	float ReportInterval = 5.f;
+	// GCを行う間隔(処理したアイテム数)。0以下でGCを行わない
+	int32 GCInterval = 0;
+
+private:
+	// ルートのタスクを実行し、終了したらループを抜ける
+	unco::FObjectTask RunRoot(FString Params);
+	// アイテムを1つ処理して同時実行数の枠を返す
+	unco::FObjectTask RunItem(FSoftObjectPath Item, unco::FAsyncSemaphoreGuard Permit);
+
+	// 1フレーム分の更新を行う
+	void TickFrame(float DeltaTime);
+	void ReportProgress(double ElapsedSeconds) const;
+
+	int32 NumItems     = 0;
+	int32 NumProcessed = 0;
+	int32 NumFailed    = 0;
+	bool  bFinished    = false;
+};
@@ -3,106 +3,414 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "Subsystems/EngineSubsystem.h"
 #include "Subsystems/WorldSubsystem.h"
+#include "UncoDistributedFrame.h"
+#include "UncoFrameBudget.h"
 #include "UncoObjectGenerator.h"
 #include "UncoObjectTask.h"
+#include "UncoTaskRegistry.h"
+#include "UncoTween.h"
+#include "UncoWaitList.h"
 #include "UncoScheduler.generated.h"
 
-namespace unco
+namespace unco::details
 {
+	struct FSchedulerTestDriver;
+
+	/**
+	 * @brief スケジューラーのTick毎に更新される待機ノード
+	 *
+	 * 複数フレームに渡って処理を行うAwaiterが自身をノードとして登録する。
+	*/
+	struct FTickWaitNode : public FWaitNode
+	{
+		/**
+		 * Tick毎に呼ばれる
+		 * @param Node 待機ノード
+		 * @param DeltaTime 経過時間
+		 * @return trueの場合は待機を終了してコルーチンを再開する
+		 */
+		using FOnTick = bool (*)(FTickWaitNode& Node, float DeltaTime);
+
+		/**
+		 * @brief ワールドコンテキストのスケジューラーに登録してコルーチンを待機させる
+		 *
+		 * ノードはAwaiter(=コルーチンフレーム)内にある為、登録・再開でヒープ確保は発生しない。
+		 * 登録の識別にはノード自身を使うので、IDの衝突も発生しない。
+		 * ワールドコンテキストが破棄された場合、スケジューラーはOnTickも再開も行わずに登録を解除する。
+		 * @param WorldContext ワールドコンテキスト
+		 * @param coroutine 再開するコルーチン
+		 * @param InOnTick Tick毎の判定
+		 * @return スケジューラーが無く登録出来なかった場合はfalse
+		 */
+		UNREALCOROUTINE_API bool SuspendOnTick(const UObject*          WorldContext,
+		                                       std::coroutine_handle<> coroutine,
+		                                       FOnTick                 InOnTick);
+
+		FOnTick                 OnTick = nullptr;
+		std::coroutine_handle<> Coroutine;
+		// SuspendOnTickのワールドコンテキスト
+		// 生存判定と重要度の判定に使用する
+		FWeakObjectPtr ContextObject;
+		// 重要度が低い為に更新を飛ばしたフレーム数と経過時間
+		// 次の更新で経過時間にまとめて加算する
+		int32 SkippedFrames = 0;
+		float SkippedTime   = 0.f;
+		// 再開の混雑時に再開を遅らせて良い時間(秒)。0以下で遅らせない
+		float LatenessTolerance = 0.f;
+		// 再開を遅らせた時間
+		float Lateness = 0.f;
+		// OnTickで再開の条件を満たしたか？(再開を遅らせている間は再判定しない)
+		bool bDue = false;
+	};
 
-	struct FCacheObjectTask
+	/**
+	 * @brief 条件を満たすまで待機するノード
+	 *
+	 * スケジューラーは待機中のノードを連続した配列で管理し、Tick毎に1度の走査でまとめて条件を判定する。
+	*/
+	struct UNREALCOROUTINE_API FWaitUntilNode : public FCoroutineWaitNode
 	{
+		/**
+		 * 条件の判定
+		 * @param Node 待機ノード
+		 * @return trueの場合は待機を終了してコルーチンを再開する
+		 */
+		using FEvaluate = bool (*)(FWaitUntilNode& Node);
 
-		friend class UUncoScheduler;
-		using promise_type = unco::FObjectTaskPromise;
+		FWaitUntilNode() = default;
+		~FWaitUntilNode();
 
-		explicit FCacheObjectTask(std::coroutine_handle<promise_type> p, FWeakObjectPtr InObjectPtr) noexcept
-		    : CoroutineHandle(p)
-		    , HostObject(InObjectPtr)
+		// コピーされたノードは登録を引き継がない
+		FWaitUntilNode(const FWaitUntilNode& Other) noexcept
+		    : FCoroutineWaitNode(Other)
+		    , Evaluate(Other.Evaluate)
 		{
 		}
+		void operator=(const FWaitUntilNode&) = delete;
 
-		~FCacheObjectTask();
-
-		// コピー禁止+ムーブ禁止
-		// メンバ変数に持たせない為
-		FCacheObjectTask(const FCacheObjectTask&) = delete;
-		void operator=(const FCacheObjectTask&) = delete;
-		FCacheObjectTask(FCacheObjectTask&&)    = delete;
-		void operator=(FCacheObjectTask&&) = delete;
+		/**
+		 * @brief ワールドコンテキストのスケジューラーに登録してコルーチンを待機させる
+		 *
+		 * ワールドコンテキストが破棄された場合、スケジューラーは判定も再開も行わずに登録を解除する。
+		 * @param WorldContext ワールドコンテキスト
+		 * @param coroutine 再開するコルーチン
+		 * @param InEvaluate 条件の判定
+		 * @param Cadence 判定を行う間隔(Tick数)
+		 * @return スケジューラーが無く登録出来なかった場合はfalse
+		 */
+		bool SuspendUntil(const UObject*          WorldContext,
+		                  std::coroutine_handle<> coroutine,
+		                  FEvaluate               InEvaluate,
+		                  int32                   Cadence);
 
-		bool IsValid() const;
+		FEvaluate Evaluate = nullptr;
 
 	private:
-		std::coroutine_handle<promise_type> CoroutineHandle;
-		FWeakObjectPtr                      HostObject;
+		friend class ::UUncoScheduler;
+
+		TWeakObjectPtr<UUncoScheduler> Scheduler;
+		// SuspendUntilのワールドコンテキスト
+		FWeakObjectPtr ContextObject;
+		// スケジューラーの配列上の位置
+		int32 EntryIndex = INDEX_NONE;
 	};
 
-	struct FDistributedFrameInfo
+	// スケジューラーが保持する条件待機の情報
+	struct FWaitUntilEntry
 	{
-		FDistributedFrameInfo(FObjectGenerator&& InGenerator, float InFrameTime) noexcept
-		    : Generator(std::move(InGenerator))
-		    , FrameTime(InFrameTime)
-		{
-		}
-
-		FObjectGenerator Generator;
-		float            FrameTime;
+		FWaitUntilNode* Node;
+		int32           Cadence;
+		// 次に判定するまでのTick数
+		int32 Countdown;
 	};
+} // namespace unco::details
+
+namespace unco
+{
+
+	/**
+	 * @brief ホストオブジェクトの重要度を返す関数
+	 *
+	 * 1以上で通常通り、0以下で停止、その間は重要度に応じて実行頻度・処理量を減らす。
+	 */
+	using FSignificanceProvider = TFunction<float(const UObject* Host)>;
 
 } // namespace unco
 
 /**
- * 
+ * @brief コルーチンスケジューラー
+ *
+ * ワールド毎のスケジューラー(UUncoWorldScheduler)とエンジン全体のスケジューラー(UUncoEngineScheduler)が所有し、
+ * 所有者のTickで更新される。
+ * ワールドのスケジューラーのタスクはワールドの破棄(レベル遷移)で破棄され、
+ * エンジンのスケジューラーのタスクはレベル遷移を跨いで実行を続ける。
  */
-UCLASS()
-class UUncoScheduler : public UTickableWorldSubsystem
+UCLASS(Transient)
+class UUncoScheduler : public UObject
 {
 	GENERATED_BODY()
 
 private:
 	friend struct unco::FObjectTask;
 	friend struct unco::FObjectGenerator;
+	friend class UUncoWorldScheduler;
+	friend class UUncoEngineScheduler;
+	friend struct unco::details::FWaitUntilNode;
+	friend struct unco::details::FTweenNode;
+	friend struct unco::details::FSchedulerTestDriver;
+	friend unco::details::FTaskRegistry* unco::details::FindTaskRegistry(const UObject* Host);
 
-	// Begin USubsystem
-
-	// サブシステムの初期化
-	virtual void Initialize(FSubsystemCollectionBase& Collection);
-	// サブシステムの終了
-	virtual void Deinitialize();
-
-	// End USubsystem
-
-	// Begin UTickableWorldSubsystem
-	virtual void    Tick(float DeltaTime) override;
-	virtual TStatId GetStatId() const override;
-	// End UTickableWorldSubsystem
+	// 所有者の初期化時に呼ばれる
+	void Initialize();
+	// 所有者の終了時に呼ばれる
+	// 残っているタスクは全て破棄される
+	// 他が所有するタスクの待機は登録を解除するだけなので、それらのコルーチンは再開されなくなる
+	void Deinitialize();
+	// 所有者のTickから呼ばれる
+	void Tick(float DeltaTime);
 
 public:
 	/**
 	 * @brief コルーチンスケジューラーを取得する
+	 *
+	 * ワールドに属するオブジェクトの場合はワールドのスケジューラーを、
+	 * ワールドに属さないオブジェクトの場合はエンジンのスケジューラーを返す。
+	 * スケジューラー自体を渡した場合はそのスケジューラーを返す。
 	 * @param InWorldContext ワールドコンテキスト
 	 * @return 
 	*/
-	static UUncoScheduler* Get(const UObject* InWorldContext);
+	static UNREALCOROUTINE_API UUncoScheduler* Get(const UObject* InWorldContext);
+
+	/**
+	 * @brief エンジン全体のスケジューラーを取得する
+	 *
+	 * ワールドコンテキストとしてAwaiterに渡すとレベル遷移中も待機を続けられる。
+	 * @return エンジンが初期化されていない場合はnullptr
+	*/
+	static UNREALCOROUTINE_API UUncoScheduler* GetEngineScheduler();
+
+	/**
+	 * @brief タスクをこのスケジューラーに所有させる
+	 *
+	 * 通常はホストオブジェクトのワールドのスケジューラーに所有されるが、
+	 * エンジンのスケジューラーに所有させるとワールドが破棄されてもタスクは破棄されない。
+	 * ホストオブジェクトが破棄された場合は破棄される。
+	 *
+	 * @code
+	 * UUncoScheduler::GetEngineScheduler()->Adopt(PreloadNextMap());
+	 * @endcode
+	 * @param Task コルーチン関数の戻り値
+	*/
+	UNREALCOROUTINE_API void Adopt(unco::FObjectTask&& Task);
 
 	/**
 	 * @brief 分散フレーム実行をリクエストする
 	 * @param InWorldContext ワールドコンテキスト
-	 * @param InFrameTime 1フレームに実行する時間(sec)
+	 * @param InFrameTime 1フレームに実行する時間(ms)
 	 * @param Generator 実行するコルーチン
 	*/
 	static UNREALCOROUTINE_API void DistributedFrame(const UObject*           InWorldContext,
 	                                                 float                    InFrameTime,
 	                                                 unco::FObjectGenerator&& Generator);
 
+	/**
+	 * @brief 処理量を指定して分散フレーム実行をリクエストする
+	 *
+	 * Countは1フレームのMoveNextの回数、CostUnitsはco_yieldした値(1未満は1として扱う)の合計で制限する。
+	 * 時間を指定しない場合は時計を読まない為、フレームレートやマシンに依らず毎フレーム同じ処理量になる。
+	 * bCarryOverを指定した場合、他の制限で使い切れなかったCountとCostUnits(1フレーム分まで)、
+	 * 超過したCostUnitsを次のフレームに持ち越す。
+	 * どの項目も制限していない場合(FFrameBudget{})は1フレームに1ステップずつ実行する。
+	 * @param InWorldContext ワールドコンテキスト
+	 * @param Budget 1フレームの処理量
+	 * @param Generator 実行するコルーチン
+	 * @param bCarryOver 回数・コストの未使用分とコストの超過分を次のフレームに持ち越すか
+	*/
+	static UNREALCOROUTINE_API void DistributedFrame(const UObject*            InWorldContext,
+	                                                 const unco::FFrameBudget& Budget,
+	                                                 unco::FObjectGenerator&&  Generator,
+	                                                 bool                      bCarryOver = false);
+
+	/**
+	 * @brief Tick毎に更新される待機ノードを登録する
+	 * ノードが破棄された場合は自動的に登録が解除される
+	 * @param Node 待機ノード
+	*/
+	UNREALCOROUTINE_API void AddTickWaiter(unco::details::FTickWaitNode& Node);
+
+	/**
+	 * @brief 次のTickの先頭でコルーチンを再開する
+	 *
+	 * イベント駆動のAwaiterがイベントのコールスタック上で再開しない為に使用する。
+	 * ノードが破棄された場合は自動的に登録が解除される
+	 * @param Node 待機ノード
+	*/
+	UNREALCOROUTINE_API void ScheduleResume(unco::details::FCoroutineWaitNode& Node);
+
+	/**
+	 * @brief ホストオブジェクトの重要度で実行頻度を調整する
+	 *
+	 * 重要度Sが1未満の場合、Tick毎の待機ノード(AsyncDelay・DelayUntilNextTick等)は1/Sフレーム毎
+	 * (最大MaxTickIntervalフレーム毎)に更新し、分散フレーム実行の1フレームの処理量はS倍にする。
+	 * 0以下の場合は重要度が上がるまで更新しない。飛ばしたフレームの経過時間は次の更新でまとめて渡す。
+	 * 待機ノードはワールドコンテキスト、分散フレーム実行はホストオブジェクトの重要度を使用する。
+	 * イベントで再開が予約されたコルーチンは調整しない。
+	 *
+	 * @code
+	 * Scheduler->SetSignificanceProvider([World](const UObject* Host) {
+	 *     USignificanceManager* Manager = USignificanceManager::Get(World);
+	 *     return Manager != nullptr ? Manager->GetSignificance(Host) : 1.f;
+	 * });
+	 * @endcode
+	 * @param InProvider 重要度を返す関数。nullptrで調整を止める
+	 * @param InMaxTickInterval 待機ノードを更新する最大の間隔(フレーム)
+	*/
+	UNREALCOROUTINE_API void SetSignificanceProvider(unco::FSignificanceProvider InProvider,
+	                                                 int32                       InMaxTickInterval = 4);
+
+	/**
+	 * @brief 1フレームに再開するTick毎の待機の数を平準化する
+	 *
+	 * このフレームで既にMaxResumesPerFrame個再開している場合、LatenessToleranceを持つ待機
+	 * (AsyncDelay・AsyncSetTimerの引数で指定)の再開を次のフレーム以降に遅らせる。
+	 * 遅れが許容時間に達した待機は上限を超えていても再開する。
+	 * 同じ時刻に一斉に待機したコルーチンの再開が1フレームに集中するのを防ぐ。
+	 * @param InMaxResumesPerFrame 1フレームの再開数の目安。0以下で無効
+	*/
+	UNREALCOROUTINE_API void SetResumeQuota(int32 InMaxResumesPerFrame);
+
+	/**
+	 * @brief 条件を満たすまで待機するノードを登録する
+	 * ノードが破棄された場合は自動的に登録が解除される
+	 * @param Node 待機ノード
+	 * @param Cadence 判定を行う間隔(Tick数)
+	*/
+	UNREALCOROUTINE_API void AddWaitUntil(unco::details::FWaitUntilNode& Node, int32 Cadence);
+
+	/**
+	 * @brief トゥイーンの待機ノードを登録する
+	 * ノードが破棄された場合は自動的に登録が解除される
+	 * @param Node 待機ノード
+	 * @param Duration 補間時間(秒)
+	 * @param Easing イージング
+	*/
+	UNREALCOROUTINE_API void AddTween(unco::details::FTweenNode& Node, float Duration, unco::ETweenEasing Easing);
+
+	/**
+	 * @brief スケジューラーの時刻を取得する
+	 *
+	 * Tickの経過時間を積算した時刻(秒)。ワールドの時間が進まない環境(エンジンのスケジューラー・コマンドレット)でも進む。
+	 * @return 初期化からの経過時間(秒)
+	*/
+	double GetTimeSeconds() const
+	{
+		return TimeSeconds;
+	}
+
+private:
+	// 終了したタスクをまとめて破棄する
+	void CollectFinishedTasks();
+	// GC後に呼び出し元オブジェクトが破棄されたタスクを破棄する
+	void OnPostGarbageCollect();
+	// ホストオブジェクトの重要度を取得する
+	float GetSignificance(const UObject* Host) const;
+	// 重要度からこのTickで待機ノードを更新するか判定する
+	bool ShouldTickWaiter(unco::details::FTickWaitNode& Node, float DeltaTime) const;
+	// 条件待機を解除する
+	void RemoveWaitUntil(unco::details::FWaitUntilNode& Node);
+	// 条件待機をまとめて判定して条件を満たしたものを再開する
+	void EvaluateWaitUntil();
+	// トゥイーンを解除する
+	void RemoveTween(unco::details::FTweenNode& Node);
+	// 再開数の上限から待機の再開を遅らせるか判定する
+	bool ShouldDeferResume(unco::details::FTickWaitNode& Node, float DeltaTime) const;
+
+	unco::details::TWaitList<unco::details::FCoroutineWaitNode> ReadyList;
+	unco::details::TWaitList<unco::details::FTickWaitNode> TickWaiters;
+	// 終了したタスクは次のTickでまとめて破棄される
+	unco::details::FTaskRegistry        TaskRegistry;
+	FDelegateHandle                     PostGarbageCollectHandle;
+	bool                                bSweepInvalidHosts = false;
+	unco::details::FDistributedFrameList DistributedFrames;
+	unco::FSignificanceProvider         SignificanceProvider;
+	int32                               MaxTickInterval = 4;
+	int32                               ResumeQuota     = 0;
+	// このTickで再開したTick毎の待機の数
+	int32                               NumTickResumes = 0;
+	// Tickの経過時間の積算
+	double                              TimeSeconds = 0.0;
+	TArray<unco::details::FWaitUntilEntry> WaitUntilEntries;
+	unco::details::FTweenSet               Tweens;
+};
+
+/**
+ * @brief ワールド毎のコルーチンスケジューラー
+ *
+ * ワールドのTickでスケジューラーを更新し、ワールドの破棄時にタスクを破棄する。
+ */
+UCLASS()
+class UUncoWorldScheduler : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
 public:
-	void RegisterTask(FWeakObjectPtr InObject, std::coroutine_handle<unco::FObjectTaskPromise> InPromise);
-	void UnregisterTask(FWeakObjectPtr InObject, std::coroutine_handle<unco::FObjectTaskPromise> InPromise);
+	UUncoScheduler* GetScheduler() const
+	{
+		return Scheduler;
+	}
+
 private:
-	TArray<unco::FCacheObjectTask>      Tasks;
-	TArray<unco::FDistributedFrameInfo> DistributedFrameLists;
-	TArray<unco::FDistributedFrameInfo> DelayDistributedFrameLists;
-	bool                                bIsDistributedFrame = false;
+	// Begin USubsystem
+
+	// サブシステムの初期化
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	// サブシステムの終了
+	virtual void Deinitialize() override;
+
+	// End USubsystem
+
+	// Begin UTickableWorldSubsystem
+	virtual void    Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	// End UTickableWorldSubsystem
+
+	UPROPERTY(Transient)
+	TObjectPtr<UUncoScheduler> Scheduler;
+};
+
+/**
+ * @brief エンジン全体のコルーチンスケジューラー
+ *
+ * コアティッカーでスケジューラーを更新する為、ワールドが存在しない間(レベル遷移・コマンドレット)も動作する。
+ */
+UCLASS()
+class UUncoEngineScheduler : public UEngineSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UUncoScheduler* GetScheduler() const
+	{
+		return Scheduler;
+	}
+
+private:
+	// Begin USubsystem
+
+	// サブシステムの初期化
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	// サブシステムの終了
+	virtual void Deinitialize() override;
+
+	// End USubsystem
+
+	bool Tick(float DeltaTime);
+
+	UPROPERTY(Transient)
+	TObjectPtr<UUncoScheduler> Scheduler;
+
+	FTSTicker::FDelegateHandle TickHandle;
 };
@@ -0,0 +1,193 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "HAL/MemoryBase.h"
+#include "Misc/AutomationTest.h"
+#include "UObject/Package.h"
+#include "UncoAsyncSystemLibrary.h"
+#include "UncoObjectTask.h"
+#include "UncoScheduler.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace unco::details
+{
+
+	namespace
+	{
+		/**
+		 * @brief 計測中のスレッドのヒープ確保を数える
+		 *
+		 * 計測の間だけGMallocと差し替え、確保・解放は元のアロケーターにそのまま渡す。
+		 * 他のスレッドの確保は数えない。
+		*/
+		class FCountingMalloc final : public FMalloc
+		{
+		public:
+			void Begin()
+			{
+				check(IsInGameThread());
+				Inner          = GMalloc;
+				ThreadId       = FPlatformTLS::GetCurrentThreadId();
+				NumAllocations = 0;
+				GMalloc        = this;
+			}
+
+			int32 End()
+			{
+				GMalloc = Inner;
+				return NumAllocations;
+			}
+
+			virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+			{
+				Record();
+				return Inner->Malloc(Count, Alignment);
+			}
+			virtual void* TryMalloc(SIZE_T Count, uint32 Alignment) override
+			{
+				Record();
+				return Inner->TryMalloc(Count, Alignment);
+			}
+			virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+			{
+				if ( Count > 0 )
+				{
+					Record();
+				}
+				return Inner->Realloc(Original, Count, Alignment);
+			}
+			virtual void* TryRealloc(void* Original, SIZE_T Count, uint32 Alignment) override
+			{
+				if ( Count > 0 )
+				{
+					Record();
+				}
+				return Inner->TryRealloc(Original, Count, Alignment);
+			}
+			virtual void Free(void* Original) override
+			{
+				Inner->Free(Original);
+			}
+			virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override
+			{
+				return Inner->QuantizeSize(Count, Alignment);
+			}
+			virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override
+			{
+				return Inner->GetAllocationSize(Original, SizeOut);
+			}
+			virtual void Trim(bool bTrimThreadCaches) override
+			{
+				Inner->Trim(bTrimThreadCaches);
+			}
+			virtual void SetupTLSCachesOnCurrentThread() override
+			{
+				Inner->SetupTLSCachesOnCurrentThread();
+			}
+			virtual void ClearAndDisableTLSCachesOnCurrentThread() override
+			{
+				Inner->ClearAndDisableTLSCachesOnCurrentThread();
+			}
+			virtual bool IsInternallyThreadSafe() const override
+			{
+				return Inner->IsInternallyThreadSafe();
+			}
+			virtual bool ValidateHeap() override
+			{
+				return Inner->ValidateHeap();
+			}
+			virtual const TCHAR* GetDescriptiveName() override
+			{
+				return Inner->GetDescriptiveName();
+			}
+
+		private:
+			void Record()
+			{
+				if ( FPlatformTLS::GetCurrentThreadId() == ThreadId )
+				{
+					++NumAllocations;
+				}
+			}
+
+			FMalloc* Inner          = nullptr;
+			uint32   ThreadId       = 0;
+			int32    NumAllocations = 0;
+		};
+
+		// 待機時間より長いDeltaTimeでTickするとTick毎に1度再開する
+		FObjectTask SuspendResumeLoop(UObject* Host, int32* NumResumes)
+		{
+			while ( true )
+			{
+				co_await unco::AsyncDelay(Host, 0.01f);
+				++*NumResumes;
+			}
+		}
+	} // namespace
+
+	/**
+	 * @brief テスト用にスケジューラーを手動で駆動する
+	 *
+	 * ワールドに属さない専用のスケジューラーを作成し、そのスケジューラー自体をホストにする。
+	*/
+	struct FSchedulerTestDriver
+	{
+		FSchedulerTestDriver()
+		{
+			Scheduler = NewObject<UUncoScheduler>(GetTransientPackage());
+			Scheduler->AddToRoot();
+			Scheduler->Initialize();
+		}
+
+		~FSchedulerTestDriver()
+		{
+			Scheduler->Deinitialize();
+			Scheduler->RemoveFromRoot();
+		}
+
+		void Tick(float DeltaTime)
+		{
+			Scheduler->Tick(DeltaTime);
+		}
+
+		UUncoScheduler* Scheduler = nullptr;
+	};
+
+} // namespace unco::details
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FUncoSuspendResumeAllocationTest,
+                                 "UnrealCoroutine.Scheduler.SuspendResumeAllocations",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext |
+                                     EAutomationTestFlags::EngineFilter)
+
+bool FUncoSuspendResumeAllocationTest::RunTest(const FString& Parameters)
+{
+	using namespace unco::details;
+
+	FSchedulerTestDriver Driver;
+	int32                NumResumes = 0;
+
+	// フレームの確保とタスクの登録は計測に含めない
+	SuspendResumeLoop(Driver.Scheduler, &NumResumes);
+	// 初回のTickでスケジューラー側の配列の確保を済ませておく
+	Driver.Tick(0.02f);
+	Driver.Tick(0.02f);
+
+	const int32 NumTicks      = 8;
+	const int32 ResumesBefore = NumResumes;
+
+	static FCountingMalloc CountingMalloc;
+	CountingMalloc.Begin();
+	for ( int32 Index = 0; Index < NumTicks; ++Index )
+	{
+		Driver.Tick(0.02f);
+	}
+	const int32 NumAllocations = CountingMalloc.End();
+
+	TestEqual(TEXT("Resumes per tick"), NumResumes - ResumesBefore, NumTicks);
+	TestEqual(TEXT("Heap allocations across suspend/resume"), NumAllocations, 0);
+	return true;
+}
+
+#endif
@@ -0,0 +1,101 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "UncoAsyncAssetManager.h"
+
+#include "Engine/AssetManager.h"
+#include "UnrealCoroutine.h"
+
+namespace unco::details
+{
+
+	////////////////////////////////////////////////////////
+	// FPrimaryAssetsAwaiterBase
+
+	FPrimaryAssetsAwaiterBase::FPrimaryAssetsAwaiterBase(const UObject*          InWorldContext,
+	                                                     TArray<FPrimaryAssetId> InAssetIds,
+	                                                     TArray<FName>           InAddBundles,
+	                                                     TArray<FName>           InRemoveBundles,
+	                                                     bool                    bInRemoveAllBundles,
+	                                                     EMode                   InMode,
+	                                                     TAsyncLoadPriority      InPriority,
+	                                                     FAsyncProgress*         InProgress)
+	    : WorldContext(InWorldContext)
+	    , AssetIds(MoveTemp(InAssetIds))
+	    , AddBundles(MoveTemp(InAddBundles))
+	    , RemoveBundles(MoveTemp(InRemoveBundles))
+	    , Progress(InProgress)
+	    , Priority(InPriority)
+	    , Mode(InMode)
+	    , bRemoveAllBundles(bInRemoveAllBundles)
+	{
+	}
+
+	bool FPrimaryAssetsAwaiterBase::await_ready()
+	{
+		UAssetManager* AssetManager = UAssetManager::GetIfValid();
+		if ( AssetManager == nullptr )
+		{
+			UE_LOG(LogUnco, Warning, TEXT("AssetManager is not available"));
+			return true;
+		}
+
+		if ( AssetIds.Num() > 0 )
+		{
+			// メモリの計上はAssetManager側で行われるのでUncoのタグは付けない
+			Handle = Mode == EMode::Load
+			           ? AssetManager->LoadPrimaryAssets(AssetIds, AddBundles, FStreamableDelegate(), Priority)
+			           : AssetManager->ChangeBundleStateForPrimaryAssets(AssetIds,
+			                                                             AddBundles,
+			                                                             RemoveBundles,
+			                                                             bRemoveAllBundles,
+			                                                             FStreamableDelegate(),
+			                                                             Priority);
+		}
+
+		const bool bCompleted = IsCompleted();
+		UpdateProgress(bCompleted ? 1.f : 0.f);
+		return bCompleted;
+	}
+
+	bool FPrimaryAssetsAwaiterBase::await_suspend(std::coroutine_handle<> coroutine)
+	{
+		return SuspendOnTick(WorldContext.Get(), coroutine, &FPrimaryAssetsAwaiterBase::OnTickLoad);
+	}
+
+	TArray<UObject*> FPrimaryAssetsAwaiterBase::GetLoadedObjects() const
+	{
+		TArray<UObject*> Result;
+		Result.Reserve(AssetIds.Num());
+
+		const UAssetManager* AssetManager = UAssetManager::GetIfValid();
+		for ( const FPrimaryAssetId& AssetId : AssetIds )
+		{
+			Result.Add(AssetManager != nullptr ? AssetManager->GetPrimaryAssetObject(AssetId) : nullptr);
+		}
+		return Result;
+	}
+
+	bool FPrimaryAssetsAwaiterBase::OnTickLoad(FTickWaitNode& Node, float DeltaTime)
+	{
+		const FPrimaryAssetsAwaiterBase& Self = static_cast<FPrimaryAssetsAwaiterBase&>(Node);
+
+		const bool bCompleted = Self.IsCompleted();
+		Self.UpdateProgress(bCompleted ? 1.f : Self.Handle->GetProgress());
+		return bCompleted;
+	}
+
+	bool FPrimaryAssetsAwaiterBase::IsCompleted() const
+	{
+		// 全て読み込み済みの場合はハンドルが返されない
+		return !Handle.IsValid() || Handle->HasLoadCompleted() || Handle->WasCanceled();
+	}
+
+	void FPrimaryAssetsAwaiterBase::UpdateProgress(float Value) const
+	{
+		if ( Progress != nullptr )
+		{
+			Progress->Value = Value;
+		}
+	}
+
+} // namespace unco::details
@@ -0,0 +1,296 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "UncoAsyncDelegate.h"
+
+#include "UObject/StrongObjectPtr.h"
+#include "UObject/UnrealType.h"
+#include "UncoDelegateListener.h"
+#include "UncoMemory.h"
+
+namespace unco::details
+{
+
+	namespace
+	{
+		// デリゲートのアドレスをキーにした待機リスト
+		// ゲームスレッドからのみアクセスされる
+		TMap<const void*, TUniquePtr<FDelegateWaitListBase>> GDelegateWaitLists;
+	} // namespace
+
+	////////////////////////////////////////////////////////
+	// FDynamicDelegateWaitList
+
+	class FDynamicDelegateWaitList final : public FDelegateWaitListBase
+	{
+	public:
+		FDynamicDelegateWaitList(const UObject*            InOwner,
+		                         FMulticastScriptDelegate& InDelegate)
+		    : FDelegateWaitListBase(InOwner, &InDelegate)
+		    , Delegate(InDelegate)
+		{
+			Listener.Reset(NewObject<UUncoDelegateListener>(GetTransientPackage()));
+			Listener->WaitList = this;
+
+			FScriptDelegate ScriptDelegate;
+			ScriptDelegate.BindUFunction(
+			    Listener.Get(),
+			    GET_FUNCTION_NAME_CHECKED(UUncoDelegateListener, OnBroadcast));
+			Delegate.AddUnique(ScriptDelegate);
+		}
+
+		virtual ~FDynamicDelegateWaitList() override
+		{
+			if ( Listener.IsValid() )
+			{
+				Listener->WaitList = nullptr;
+			}
+		}
+
+		// シグネチャから引数のオフセットを収集する
+		bool Setup(const UObject* InOwner, int32 NumParams)
+		{
+			if ( InOwner == nullptr )
+			{
+				return NumParams == 0;
+			}
+
+			for ( TFieldIterator<FMulticastDelegateProperty> It(InOwner->GetClass()); It; ++It )
+			{
+				if ( It->ContainerPtrToValuePtr<void>(const_cast<UObject*>(InOwner)) !=
+				     &Delegate )
+				{
+					continue;
+				}
+				for ( TFieldIterator<FProperty> ParamIt(It->SignatureFunction);
+				      ParamIt && ParamIt->HasAnyPropertyFlags(CPF_Parm);
+				      ++ParamIt )
+				{
+					if ( !ParamIt->HasAnyPropertyFlags(CPF_ReturnParm) )
+					{
+						ParamOffsets.Add(ParamIt->GetOffset_ForUFunction());
+					}
+				}
+				return ParamOffsets.Num() == NumParams;
+			}
+
+			// リフレクションに登録されていないデリゲートは引数を受け取れない
+			return NumParams == 0;
+		}
+
+		virtual void Unbind() override
+		{
+			if ( Listener.IsValid() )
+			{
+				Delegate.Remove(
+				    Listener.Get(),
+				    GET_FUNCTION_NAME_CHECKED(UUncoDelegateListener, OnBroadcast));
+			}
+		}
+
+		void OnProcessEvent(void* Parms)
+		{
+			FDynamicDelegatePayload Payload;
+			Payload.ParamOffsets = ParamOffsets.GetData();
+			Payload.NumParams    = ParamOffsets.Num();
+			Payload.Parms        = static_cast<uint8*>(Parms);
+			Broadcast(&Payload);
+		}
+
+	private:
+		FMulticastScriptDelegate&               Delegate;
+		TStrongObjectPtr<UUncoDelegateListener> Listener;
+		TArray<int32, TInlineAllocator<4>>      ParamOffsets;
+	};
+
+	////////////////////////////////////////////////////////
+	// FDelegateWaitListBase
+
+	FDelegateWaitListBase::FDelegateWaitListBase(const UObject* InOwner,
+	                                             const void*    InDelegate)
+	    : Owner(InOwner)
+	    , Delegate(InDelegate)
+	    , bHasOwner(InOwner != nullptr)
+	{
+	}
+
+	FDelegateWaitListBase::~FDelegateWaitListBase()
+	{
+		// 残っている待機者は切り離す
+		Waiters.Reset();
+	}
+
+	bool FDelegateWaitListBase::IsStale() const
+	{
+		return bHasOwner && !Owner.IsValid();
+	}
+
+	void FDelegateWaitListBase::Broadcast(const void* Payload)
+	{
+		// 再開中に待機の追加・破棄が行われても安全な様に一旦リストを退避させる
+		TWaitList<FDelegateWaitNode> Pending;
+		Pending.Append(Waiters);
+
+		++BroadcastDepth;
+		while ( FDelegateWaitNode* Node = Pending.PopFront() )
+		{
+			if ( Node->OnBroadcast(*Node, Payload) )
+			{
+				// コルーチンを再開
+				if ( Node->Coroutine )
+				{
+					Node->Coroutine.resume();
+				}
+			}
+			else
+			{
+				// フィルターで弾かれたので待機を継続
+				Waiters.PushBack(*Node);
+			}
+		}
+		--BroadcastDepth;
+
+		if ( BroadcastDepth == 0 && (Waiters.IsEmpty() || IsStale()) )
+		{
+			// 待機者がいなくなったのでバインドを解除する
+			// この呼び出しで自身が破棄される為以降メンバーに触れてはいけない
+			ReleaseDelegateWaitList(Delegate);
+		}
+	}
+
+	////////////////////////////////////////////////////////
+	// Registry
+
+	FDelegateWaitListBase* FindDelegateWaitList(const void* Delegate)
+	{
+		check(IsInGameThread());
+
+		TUniquePtr<FDelegateWaitListBase>* Found = GDelegateWaitLists.Find(Delegate);
+		if ( Found == nullptr )
+		{
+			return nullptr;
+		}
+		if ( (*Found)->IsStale() )
+		{
+			// 所有オブジェクトが破棄されているのでデリゲートには触れずに破棄する
+			// 同じアドレスに別のデリゲートが作られている可能性がある為
+			// ブロードキャスト中の場合は終了時に破棄される
+			if ( !(*Found)->IsBroadcasting() )
+			{
+				GDelegateWaitLists.Remove(Delegate);
+			}
+			return nullptr;
+		}
+		return Found->Get();
+	}
+
+	FDelegateWaitListBase* RegisterDelegateWaitList(
+	    const void*                         Delegate,
+	    TUniquePtr<FDelegateWaitListBase>&& WaitList)
+	{
+		check(IsInGameThread());
+
+		if ( !WaitList.IsValid() )
+		{
+			return nullptr;
+		}
+		if ( GDelegateWaitLists.Contains(Delegate) )
+		{
+			// ブロードキャスト中の破棄待ちの待機リストが残っているので置き換えない
+			WaitList->Unbind();
+			return nullptr;
+		}
+		UNCO_LLM_SCOPE();
+		return GDelegateWaitLists.Add(Delegate, MoveTemp(WaitList)).Get();
+	}
+
+	void ReleaseDelegateWaitList(const void* Delegate)
+	{
+		check(IsInGameThread());
+
+		TUniquePtr<FDelegateWaitListBase>* Found = GDelegateWaitLists.Find(Delegate);
+		if ( Found == nullptr )
+		{
+			return;
+		}
+		FDelegateWaitListBase& WaitList = **Found;
+		if ( WaitList.IsBroadcasting() )
+		{
+			// ブロードキャスト中に解放すると走査中の待機リストを破棄してしまう
+			// 解放はブロードキャストの終了時に行われる
+			return;
+		}
+		if ( WaitList.IsStale() )
+		{
+			GDelegateWaitLists.Remove(Delegate);
+			return;
+		}
+		if ( WaitList.IsEmpty() )
+		{
+			WaitList.Unbind();
+			GDelegateWaitLists.Remove(Delegate);
+		}
+	}
+
+	TUniquePtr<FDelegateWaitListBase> MakeDynamicDelegateWaitList(
+	    const UObject*            Owner,
+	    FMulticastScriptDelegate& Delegate,
+	    int32                     NumParams)
+	{
+		UNCO_LLM_SCOPE();
+		TUniquePtr<FDynamicDelegateWaitList> WaitList =
+		    MakeUnique<FDynamicDelegateWaitList>(Owner, Delegate);
+		if ( !WaitList->Setup(Owner, NumParams) )
+		{
+			ensureAlwaysMsgf(false, TEXT("Dynamic delegate signature mismatch"));
+			WaitList->Unbind();
+			return nullptr;
+		}
+		return WaitList;
+	}
+
+	bool AddDynamicDelegateWaiter(const UObject*            Owner,
+	                              FMulticastScriptDelegate& Delegate,
+	                              int32                     NumParams,
+	                              FDelegateWaitNode&        Node)
+	{
+		FDelegateWaitListBase* WaitList = FindDelegateWaitList(&Delegate);
+		if ( WaitList == nullptr )
+		{
+			WaitList = RegisterDelegateWaitList(
+			    &Delegate, MakeDynamicDelegateWaitList(Owner, Delegate, NumParams));
+		}
+		if ( WaitList == nullptr )
+		{
+			return false;
+		}
+		WaitList->Add(Node);
+		return true;
+	}
+
+	void RemoveDelegateWaiter(const void* Delegate, FDelegateWaitNode& Node)
+	{
+		if ( Node.IsLinked() )
+		{
+			Node.Unlink();
+			ReleaseDelegateWaitList(Delegate);
+		}
+	}
+
+} // namespace unco::details
+
+////////////////////////////////////////////////////////
+// UUncoDelegateListener
+
+void UUncoDelegateListener::OnBroadcast() {}
+
+void UUncoDelegateListener::ProcessEvent(UFunction* Function, void* Parms)
+{
+	if ( WaitList != nullptr &&
+	     Function->GetFName() ==
+	         GET_FUNCTION_NAME_CHECKED(UUncoDelegateListener, OnBroadcast) )
+	{
+		WaitList->OnProcessEvent(Parms);
+		return;
+	}
+	Super::ProcessEvent(Function, Parms);
+}
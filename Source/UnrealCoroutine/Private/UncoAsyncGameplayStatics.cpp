@@ -1,51 +1,626 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "UncoAsyncGameplayStatics.h"
+#include "Async/Async.h"
+#include "Engine/LevelStreaming.h"
+#include "Engine/StreamableManager.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
 #include "GameFramework/GameModeBase.h"
+#include "GameFramework/SaveGame.h"
 #include "Kismet/GameplayStatics.h"
+#include "Misc/Compression.h"
+#include "PlatformFeatures.h"
+#include "SaveGameSystem.h"
+#include "UncoAsyncSystemLibrary.h"
+#include "UncoMemory.h"
+#include "UnrealCoroutine.h"
+
+DECLARE_CYCLE_STAT(TEXT("Unco_SpawnActors"), STAT_SpawnActors, STATGROUP_Unco);
+DECLARE_CYCLE_STAT(TEXT("Unco_SaveGameSerialize"), STAT_SaveGameSerialize, STATGROUP_Unco);
 
 namespace unco::details
 {
 
+	bool FGetGameModeAwaiter::FSameWorldFilter::operator()(
+	    AGameModeBase* NewGameMode) const
+	{
+		const UWorld* SelfWorld = GEngine->GetWorldFromContextObject(
+		    WorldContext.Get(), EGetWorldErrorMode::LogAndReturnNull);
+		const UWorld* GameModeWorld = GEngine->GetWorldFromContextObject(
+		    NewGameMode, EGetWorldErrorMode::LogAndReturnNull);
+
+		// 作成されたGameModeのWorldが一致している場合有効
+		return SelfWorld != nullptr && SelfWorld == GameModeWorld;
+	}
+
 	FGetGameModeAwaiter::FGetGameModeAwaiter(const UObject* InWorldContext)
-	    : WorldContext(InWorldContext)
+	    : InitializedAwaiter(nullptr,
+	                         FGameModeEvents::OnGameModeInitializedEvent(),
+	                         FSameWorldFilter{FWeakObjectPtr(InWorldContext)})
 	{
 		// コンストラクタでGameModeを取得する
 		// ゲームモードがこの時点で無ければ待機が発生する
 		GameMode = UGameplayStatics::GetGameMode(InWorldContext);
 	}
 
-	FGetGameModeAwaiter::~FGetGameModeAwaiter()
+	////////////////////////////////////////////////////////
+	// FSpawnActorsAwaiterBase
+
+	FSpawnActorsAwaiterBase::FSpawnActorsAwaiterBase(
+	    const UObject*                     InWorldContext,
+	    FSoftObjectPath                    InClass,
+	    TArray<FTransform>                 InTransforms,
+	    FFrameBudget                       InBudget,
+	    ESpawnActorCollisionHandlingMethod InCollisionHandling,
+	    AActor*                            InOwner,
+	    FPreFinishSpawning                 InPreFinishSpawning)
+	    : WorldContext(InWorldContext)
+	    , ClassPath(MoveTemp(InClass))
+	    , Transforms(MoveTemp(InTransforms))
+	    , Budget(InBudget)
+	    , CollisionHandling(InCollisionHandling)
+	    , Owner(InOwner)
+	    , PreFinishSpawning(MoveTemp(InPreFinishSpawning))
 	{
-		if ( Handle.IsValid() )
+	}
+
+	FSpawnActorsAwaiterBase::~FSpawnActorsAwaiterBase()
+	{
+		if ( LoadHandle.IsValid() )
 		{
-			// 登録を解除
-			FGameModeEvents::OnGameModeInitializedEvent().Remove(Handle);
+			LoadHandle->ReleaseHandle();
 		}
 	}
 
-	void FGetGameModeAwaiter::await_suspend(std::coroutine_handle<> coroutine)
+	bool FSpawnActorsAwaiterBase::await_suspend(std::coroutine_handle<> coroutine)
 	{
-		// ゲームモードの初期化イベントが呼ばれる場合
-		const auto OnGameModeInitialized = [=](AGameModeBase* NewGameMode)
+		if ( !SuspendOnTick(WorldContext.Get(), coroutine, &FSpawnActorsAwaiterBase::OnTickSpawn) )
 		{
-			const UWorld* SelfWorld = GEngine->GetWorldFromContextObject(
-			    WorldContext.Get(), EGetWorldErrorMode::LogAndReturnNull);
-			const UWorld* GameModeWorld = GEngine->GetWorldFromContextObject(
-			    NewGameMode, EGetWorldErrorMode::LogAndReturnNull);
+			return false;
+		}
+
+		UNCO_LLM_SCOPE();
+
+		// 既存のソフトクラスのロード経路でクラスをロードする
+		// ロード済みの場合にはハンドルは即座に完了状態になる
+		ensureAlwaysMsgf(!ClassPath.IsNull(), TEXT("Actor class Null"));
+		LoadHandle = RequestAsyncLoad(ClassPath);
+		SpawnedActors.Reserve(Transforms.Num());
+		return true;
+	}
 
-			// 作成されたGameModeのWorldが一致している場合有効
-			if ( SelfWorld == GameModeWorld )
+	TArray<AActor*> FSpawnActorsAwaiterBase::ConsumeSpawnedActors()
+	{
+		TArray<AActor*> Result;
+		Result.Reserve(Transforms.Num());
+		for ( const TWeakObjectPtr<AActor>& Actor : SpawnedActors )
+		{
+			Result.Add(Actor.Get());
+		}
+		// スポーン出来なかった分はnullptrで埋める
+		Result.SetNumZeroed(Transforms.Num());
+		SpawnedActors.Empty();
+		return Result;
+	}
+
+	bool FSpawnActorsAwaiterBase::OnTickSpawn(FTickWaitNode& Node, float DeltaTime)
+	{
+		FSpawnActorsAwaiterBase& Self = static_cast<FSpawnActorsAwaiterBase&>(Node);
+		if ( !Self.UpdateLoading() )
+		{
+			return false;
+		}
+		return Self.UpdateSpawning();
+	}
+
+	bool FSpawnActorsAwaiterBase::UpdateLoading()
+	{
+		if ( ActorClass.IsValid() )
+		{
+			return true;
+		}
+		const bool bLoaded = !LoadHandle.IsValid() || LoadHandle->HasLoadCompleted() ||
+		                     LoadHandle->WasCanceled();
+		if ( !bLoaded )
+		{
+			return false;
+		}
+
+		ActorClass = Cast<UClass>(ClassPath.ResolveObject());
+		if ( !ActorClass.IsValid() )
+		{
+			UE_LOG(LogUnco,
+			       Warning,
+			       TEXT("AsyncSpawnActors: failed to load %s"),
+			       *ClassPath.ToString());
+			// 何もスポーン出来ないが待機は終了させる
+			SpawnedActors.SetNum(Transforms.Num());
+		}
+		return true;
+	}
+
+	bool FSpawnActorsAwaiterBase::UpdateSpawning()
+	{
+		SCOPE_CYCLE_COUNTER(STAT_SpawnActors);
+
+		UWorld* World = GEngine->GetWorldFromContextObject(
+		    WorldContext.Get(), EGetWorldErrorMode::LogAndReturnNull);
+		UClass* Class = ActorClass.Get();
+		if ( !IsValid(World) || Class == nullptr )
+		{
+			return true;
+		}
+
+		FFrameBudgetTimer Timer(Budget);
+		while ( SpawnedActors.Num() < Transforms.Num() )
+		{
+			const int32       Index     = SpawnedActors.Num();
+			const FTransform& Transform = Transforms[Index];
+
+			// BeginPlayまでの初期化を遅延させて生成する
+			AActor* Actor = World->SpawnActorDeferred<AActor>(
+			    Class, Transform, Owner.Get(), nullptr, CollisionHandling);
+			if ( Actor != nullptr )
+			{
+				if ( PreFinishSpawning )
+				{
+					PreFinishSpawning(Actor, Index);
+				}
+				// 初期化処理の中で破棄された場合は完了させない
+				if ( IsValid(Actor) )
+				{
+					Actor->FinishSpawning(Transform);
+				}
+			}
+			SpawnedActors.Add(Actor);
+
+			if ( !Timer.Step() )
 			{
-				// 戻り値を保存して、コルーチンを再開
-				GameMode = NewGameMode;
-				coroutine.resume();
+				break;
 			}
+		}
+
+		return SpawnedActors.Num() >= Transforms.Num();
+	}
+
+	////////////////////////////////////////////////////////
+	// FStreamLevelAwaiter
+
+	FStreamLevelAwaiter::FStreamLevelAwaiter(const UObject*  InWorldContext,
+	                                         TArray<FName>   InLevelNames,
+	                                         EMode           InMode,
+	                                         bool            bInShouldBlock,
+	                                         FAsyncProgress* InProgress)
+	    : WorldContext(InWorldContext)
+	    , LevelNames(MoveTemp(InLevelNames))
+	    , Progress(InProgress)
+	    , Mode(InMode)
+	    , bShouldBlock(bInShouldBlock)
+	{
+	}
+
+	FStreamLevelAwaiter::~FStreamLevelAwaiter()
+	{
+		// 待機中に破棄された場合はデリゲートの待機を解除する
+		for ( FLevelNode& Node : Nodes )
+		{
+			RemoveDelegateWaiter(Node.Delegate, Node);
+		}
+	}
+
+	bool FStreamLevelAwaiter::await_ready()
+	{
+		Levels.Reserve(LevelNames.Num());
+		for ( const FName& LevelName : LevelNames )
+		{
+			ULevelStreaming* Level =
+			    UGameplayStatics::GetStreamingLevel(WorldContext.Get(), LevelName);
+			if ( Level == nullptr )
+			{
+				UE_LOG(LogUnco,
+				       Warning,
+				       TEXT("Stream level %s not found"),
+				       *LevelName.ToString());
+				continue;
+			}
+
+			RequestStreaming(Level);
+			if ( !IsLevelDone(Level) )
+			{
+				Levels.Add(Level);
+			}
+		}
+
+		if ( Levels.Num() == 0 && Progress != nullptr )
+		{
+			Progress->Value = 1.f;
+		}
+		return Levels.Num() == 0;
+	}
+
+	bool FStreamLevelAwaiter::await_suspend(std::coroutine_handle<> coroutine)
+	{
+		Scheduler = UUncoScheduler::Get(WorldContext.Get());
+		if ( !Scheduler.IsValid() )
+		{
+			// 完了を待てないのでストリーミングのリクエストだけ行い中断しない
+			return false;
+		}
+
+		UNCO_LLM_SCOPE();
+
+		ResumeNode.Coroutine = coroutine;
+
+		// 登録後はノードのアドレスが変わってはいけないので事前に確保する
+		Nodes.SetNum(Levels.Num());
+		NumPending = Levels.Num();
+		for ( int32 Index = 0; Index < Levels.Num(); ++Index )
+		{
+			ULevelStreaming*          Level    = Levels[Index].Get();
+			FMulticastScriptDelegate& Delegate = GetLevelEvent(Level);
+
+			FLevelNode& Node = Nodes[Index];
+			Node.Awaiter     = this;
+			Node.Delegate    = &Delegate;
+			Node.OnBroadcast = &FStreamLevelAwaiter::OnLevelEvent;
+			if ( !AddDynamicDelegateWaiter(Level, Delegate, 0, Node) )
+			{
+				--NumPending;
+			}
+		}
+
+		if ( Progress != nullptr )
+		{
+			// 進捗の出力先がある場合のみ毎フレーム進捗を計算する
+			ProgressNode.Awaiter = this;
+			ProgressNode.OnTick  = &FStreamLevelAwaiter::OnTickProgress;
+			Scheduler->AddTickWaiter(ProgressNode);
+		}
+
+		if ( NumPending <= 0 )
+		{
+			Scheduler->ScheduleResume(ResumeNode);
+		}
+		return true;
+	}
+
+	bool FStreamLevelAwaiter::OnLevelEvent(FDelegateWaitNode& Node, const void* Payload)
+	{
+		FStreamLevelAwaiter& Self = *static_cast<FLevelNode&>(Node).Awaiter;
+		if ( --Self.NumPending > 0 )
+		{
+			return true;
+		}
+
+		// 全てのレベルが完了したので再開を予約する
+		// デリゲートのコールスタック上では再開しない
+		Self.ProgressNode.Unlink();
+		if ( Self.Progress != nullptr )
+		{
+			Self.Progress->Value = 1.f;
+		}
+		if ( UUncoScheduler* OwnerScheduler = Self.Scheduler.Get() )
+		{
+			OwnerScheduler->ScheduleResume(Self.ResumeNode);
+		}
+		return true;
+	}
+
+	bool FStreamLevelAwaiter::OnTickProgress(FTickWaitNode& Node, float DeltaTime)
+	{
+		static_cast<FProgressNode&>(Node).Awaiter->UpdateProgress();
+		// 完了時にOnLevelEventで登録解除される
+		return false;
+	}
+
+	bool FStreamLevelAwaiter::IsLevelDone(const ULevelStreaming* Level) const
+	{
+		switch ( Mode )
+		{
+			case EMode::Load:
+				return Level->IsLevelLoaded();
+			case EMode::LoadAndShow:
+				return Level->IsLevelVisible();
+			case EMode::Unload:
+				return !Level->IsLevelLoaded();
+		}
+		return true;
+	}
+
+	void FStreamLevelAwaiter::RequestStreaming(ULevelStreaming* Level) const
+	{
+		// UGameplayStatics::LoadStreamLevel/UnloadStreamLevelと同様の状態変更を行う
+		if ( Mode == EMode::Unload )
+		{
+			Level->SetShouldBeLoaded(false);
+			Level->SetShouldBeVisible(false);
+			Level->bShouldBlockOnUnload = bShouldBlock;
+		}
+		else
+		{
+			Level->SetShouldBeLoaded(true);
+			Level->SetShouldBeVisible(Mode == EMode::LoadAndShow);
+			Level->bShouldBlockOnLoad = bShouldBlock;
+		}
+	}
+
+	FMulticastScriptDelegate& FStreamLevelAwaiter::GetLevelEvent(
+	    ULevelStreaming* Level) const
+	{
+		switch ( Mode )
+		{
+			case EMode::Load:
+				return Level->OnLevelLoaded;
+			case EMode::LoadAndShow:
+				return Level->OnLevelShown;
+			case EMode::Unload:
+				return Level->OnLevelUnloaded;
+		}
+		return Level->OnLevelLoaded;
+	}
+
+	void FStreamLevelAwaiter::UpdateProgress()
+	{
+		if ( Progress == nullptr || Levels.Num() == 0 )
+		{
+			return;
+		}
+
+		float Total = 0.f;
+		for ( const TWeakObjectPtr<ULevelStreaming>& Level : Levels )
+		{
+			if ( !Level.IsValid() || IsLevelDone(Level.Get()) )
+			{
+				Total += 1.f;
+			}
+			else if ( Mode != EMode::Unload )
+			{
+				// 読み込み中でなければ負の値が返る
+				const float Percentage =
+				    GetAsyncLoadPercentage(Level->GetWorldAssetPackageFName());
+				Total += FMath::Clamp(Percentage, 0.f, 100.f) / 100.f;
+			}
+		}
+		Progress->Value = Total / Levels.Num();
+	}
+
+	////////////////////////////////////////////////////////
+	// FSaveGameAwaiterBase
+
+	namespace
+	{
+		// 圧縮したセーブデータの先頭に付けるヘッダー
+		// 圧縮していないデータはUSaveGameのヘッダーから始まるので区別出来る
+		struct FCompressedSaveHeader
+		{
+			static constexpr uint32 MagicValue = 0x5A434E55; // "UNCZ"
+			// zlib(deflate)の理論上の最大圧縮率
+			// 展開後のサイズがこれを超える場合は壊れたデータとして扱う
+			static constexpr int64 MaxCompressionRatio = 1032;
+			// 展開後のサイズの上限
+			static constexpr int64 MaxUncompressedSize = 1024 * 1024 * 1024;
+
+			uint32 Magic            = MagicValue;
+			int32  UncompressedSize = 0;
 		};
 
-		// イベントを登録する
-		Handle = FGameModeEvents::OnGameModeInitializedEvent().AddWeakLambda(
-		    WorldContext.Get(), OnGameModeInitialized);
+		bool CompressSaveData(TArray<uint8>& Data)
+		{
+			int32         CompressedSize = FCompression::CompressMemoryBound(NAME_Zlib, Data.Num());
+			TArray<uint8> Compressed;
+			Compressed.SetNumUninitialized(sizeof(FCompressedSaveHeader) + CompressedSize);
+			if ( !FCompression::CompressMemory(NAME_Zlib,
+			                                   Compressed.GetData() + sizeof(FCompressedSaveHeader),
+			                                   CompressedSize,
+			                                   Data.GetData(),
+			                                   Data.Num()) )
+			{
+				return false;
+			}
+
+			FCompressedSaveHeader Header;
+			Header.UncompressedSize = Data.Num();
+			FMemory::Memcpy(Compressed.GetData(), &Header, sizeof(Header));
+			Compressed.SetNum(sizeof(FCompressedSaveHeader) + CompressedSize, false);
+			Data = MoveTemp(Compressed);
+			return true;
+		}
+
+		bool UncompressSaveData(TArray<uint8>& Data)
+		{
+			FCompressedSaveHeader Header;
+			if ( Data.Num() < (int32)sizeof(Header) )
+			{
+				// 非圧縮
+				return true;
+			}
+			FMemory::Memcpy(&Header, Data.GetData(), sizeof(Header));
+			if ( Header.Magic != FCompressedSaveHeader::MagicValue )
+			{
+				// 非圧縮
+				return true;
+			}
+
+			// ヘッダーはファイルから読んだ値なので確保の前に検証する
+			const int64 CompressedSize = Data.Num() - (int64)sizeof(Header);
+			if ( Header.UncompressedSize <= 0 ||
+			     Header.UncompressedSize > FCompressedSaveHeader::MaxUncompressedSize ||
+			     Header.UncompressedSize > CompressedSize * FCompressedSaveHeader::MaxCompressionRatio )
+			{
+				UE_LOG(LogUnco,
+				       Warning,
+				       TEXT("Corrupt save data: uncompressed size %d for %lld compressed bytes"),
+				       Header.UncompressedSize,
+				       CompressedSize);
+				return false;
+			}
+
+			TArray<uint8> Uncompressed;
+			Uncompressed.SetNumUninitialized(Header.UncompressedSize);
+			if ( !FCompression::UncompressMemory(NAME_Zlib,
+			                                     Uncompressed.GetData(),
+			                                     Uncompressed.Num(),
+			                                     Data.GetData() + sizeof(Header),
+			                                     Data.Num() - sizeof(Header)) )
+			{
+				return false;
+			}
+			Data = MoveTemp(Uncompressed);
+			return true;
+		}
+	} // namespace
+
+	// ワーカースレッドと共有する状態
+	// Awaiterはゲームスレッドからのみアクセスされる
+	struct FSaveGameAwaiterBase::FTaskState
+	{
+		TArray<uint8>         Data;
+		bool                  bSuccess = false;
+		FSaveGameAwaiterBase* Awaiter  = nullptr;
+	};
+
+	FSaveGameAwaiterBase::FSaveGameAwaiterBase(const UObject* InWorldContext,
+	                                           FString        InSlotName,
+	                                           int32          InUserIndex)
+	    : WorldContext(InWorldContext)
+	    , SlotName(MoveTemp(InSlotName))
+	    , UserIndex(InUserIndex)
+	{
+	}
+
+	FSaveGameAwaiterBase::~FSaveGameAwaiterBase()
+	{
+		// ワーカーでの処理中に破棄された場合は結果を受け取らない
+		if ( State.IsValid() )
+		{
+			State->Awaiter = nullptr;
+		}
+	}
+
+	bool FSaveGameAwaiterBase::Start(std::coroutine_handle<> coroutine,
+	                                 TUniqueFunction<void(FTaskState&)> Work)
+	{
+		check(IsInGameThread());
+
+		UUncoScheduler* OwnerScheduler = UUncoScheduler::Get(WorldContext.Get());
+		if ( !IsValid(OwnerScheduler) )
+		{
+			return false;
+		}
+
+		Coroutine      = coroutine;
+		Scheduler      = OwnerScheduler;
+		State->Awaiter = this;
+
+		AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask,
+		          [TaskState = State, Work = MoveTemp(Work)]() mutable
+		          {
+			          Work(*TaskState);
+
+			          AsyncTask(ENamedThreads::GameThread,
+			                    [TaskState = MoveTemp(TaskState)]()
+			                    {
+				                    if ( FSaveGameAwaiterBase* Awaiter = TaskState->Awaiter )
+				                    {
+					                    Awaiter->OnCompleted();
+				                    }
+			                    });
+		          });
+		return true;
+	}
+
+	void FSaveGameAwaiterBase::OnCompleted()
+	{
+		State->Awaiter = nullptr;
+		if ( UUncoScheduler* OwnerScheduler = Scheduler.Get() )
+		{
+			OwnerScheduler->ScheduleResume(*this);
+		}
+	}
+
+	////////////////////////////////////////////////////////
+	// FSaveGameAwaiter
+
+	FSaveGameAwaiter::FSaveGameAwaiter(const UObject* InWorldContext,
+	                                   USaveGame*     InSaveGameObject,
+	                                   FString        InSlotName,
+	                                   int32          InUserIndex,
+	                                   bool           bInCompress)
+	    : FSaveGameAwaiterBase(InWorldContext, MoveTemp(InSlotName), InUserIndex)
+	    , SaveGameObject(InSaveGameObject)
+	    , bCompress(bInCompress)
+	{
+	}
+
+	bool FSaveGameAwaiter::await_suspend(std::coroutine_handle<> coroutine)
+	{
+		ISaveGameSystem* SaveSystem = IPlatformFeaturesModule::Get().GetSaveGameSystem();
+		USaveGame*       SaveGame   = SaveGameObject.Get();
+		if ( SaveSystem == nullptr || !IsValid(SaveGame) || SlotName.IsEmpty() )
+		{
+			return false;
+		}
+
+		State = MakeShared<FTaskState, ESPMode::ThreadSafe>();
+		{
+			// UObjectのシリアライズはゲームスレッドでしか行えない
+			SCOPE_CYCLE_COUNTER(STAT_SaveGameSerialize);
+			UNCO_LLM_SCOPE();
+			if ( !UGameplayStatics::SaveGameToMemory(SaveGame, State->Data) )
+			{
+				return false;
+			}
+		}
+
+		return Start(coroutine,
+		             [SaveSystem, Slot = SlotName, User = UserIndex, bShouldCompress = bCompress](
+		                 FTaskState& TaskState)
+		             {
+			             if ( bShouldCompress && !CompressSaveData(TaskState.Data) )
+			             {
+				             return;
+			             }
+			             TaskState.bSuccess = SaveSystem->SaveGame(false, *Slot, User, TaskState.Data);
+			             TaskState.Data.Empty();
+		             });
+	}
+
+	bool FSaveGameAwaiter::await_resume() const
+	{
+		return State.IsValid() && State->bSuccess;
+	}
+
+	////////////////////////////////////////////////////////
+	// FLoadGameAwaiterBase
+
+	bool FLoadGameAwaiterBase::await_suspend(std::coroutine_handle<> coroutine)
+	{
+		ISaveGameSystem* SaveSystem = IPlatformFeaturesModule::Get().GetSaveGameSystem();
+		if ( SaveSystem == nullptr || SlotName.IsEmpty() )
+		{
+			return false;
+		}
+
+		State = MakeShared<FTaskState, ESPMode::ThreadSafe>();
+		return Start(coroutine,
+		             [SaveSystem, Slot = SlotName, User = UserIndex](FTaskState& TaskState)
+		             {
+			             TaskState.bSuccess = SaveSystem->LoadGame(false, *Slot, User, TaskState.Data)
+			                                  && UncompressSaveData(TaskState.Data);
+		             });
+	}
+
+	USaveGame* FLoadGameAwaiterBase::Deserialize() const
+	{
+		if ( !State.IsValid() || !State->bSuccess )
+		{
+			return nullptr;
+		}
+
+		SCOPE_CYCLE_COUNTER(STAT_SaveGameSerialize);
+		UNCO_LLM_SCOPE();
+		return UGameplayStatics::LoadGameFromMemory(State->Data);
 	}
 
 } // namespace unco::details
@@ -66,4 +641,60 @@ namespace unco
 		return details::FGetGameModeAwaiter(WorldContextObject);
 	}
 
+	details::FStreamLevelAwaiter AsyncLoadStreamLevel(const UObject*  WorldContextObject,
+	                                                  FName           LevelName,
+	                                                  bool            bMakeVisible,
+	                                                  bool            bShouldBlockOnLoad,
+	                                                  FAsyncProgress* Progress)
+	{
+		return AsyncLoadStreamLevels(WorldContextObject,
+		                             TArray<FName>{LevelName},
+		                             bMakeVisible,
+		                             bShouldBlockOnLoad,
+		                             Progress);
+	}
+
+	details::FStreamLevelAwaiter AsyncLoadStreamLevels(const UObject*  WorldContextObject,
+	                                                   TArray<FName>   LevelNames,
+	                                                   bool            bMakeVisible,
+	                                                   bool            bShouldBlockOnLoad,
+	                                                   FAsyncProgress* Progress)
+	{
+		using EMode = details::FStreamLevelAwaiter::EMode;
+		return details::FStreamLevelAwaiter(WorldContextObject,
+		                                    MoveTemp(LevelNames),
+		                                    bMakeVisible ? EMode::LoadAndShow : EMode::Load,
+		                                    bShouldBlockOnLoad,
+		                                    Progress);
+	}
+
+	details::FStreamLevelAwaiter AsyncUnloadStreamLevel(const UObject* WorldContextObject,
+	                                                    FName          LevelName,
+	                                                    bool           bShouldBlockOnUnload)
+	{
+		return AsyncUnloadStreamLevels(
+		    WorldContextObject, TArray<FName>{LevelName}, bShouldBlockOnUnload);
+	}
+
+	details::FStreamLevelAwaiter AsyncUnloadStreamLevels(const UObject* WorldContextObject,
+	                                                     TArray<FName>  LevelNames,
+	                                                     bool           bShouldBlockOnUnload)
+	{
+		return details::FStreamLevelAwaiter(WorldContextObject,
+		                                    MoveTemp(LevelNames),
+		                                    details::FStreamLevelAwaiter::EMode::Unload,
+		                                    bShouldBlockOnUnload,
+		                                    nullptr);
+	}
+
+	details::FSaveGameAwaiter AsyncSaveGame(const UObject* WorldContextObject,
+	                                        USaveGame*     SaveGameObject,
+	                                        const FString& SlotName,
+	                                        int32          UserIndex,
+	                                        bool           bCompress)
+	{
+		return details::FSaveGameAwaiter(
+		    WorldContextObject, SaveGameObject, SlotName, UserIndex, bCompress);
+	}
+
 } // namespace unco
@@ -0,0 +1,129 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "UncoAsyncNavigationSystem.h"
+
+#if UNCO_WITH_NAVIGATION
+
+	#include "NavigationSystem.h"
+	#include "UncoMemory.h"
+	#include "UnrealCoroutine.h"
+
+namespace unco::details
+{
+
+	namespace
+	{
+		// 探索中のAwaiter
+		// ナビゲーションシステムが発行するクエリIDは重複しないのでキーにする
+		// ゲームスレッドからのみアクセスされる
+		TMap<uint32, FFindPathAwaiter*> GPendingPathQueries;
+	} // namespace
+
+	FFindPathAwaiter::FFindPathAwaiter(const UObject*             InWorldContext,
+	                                   const FPathFindingQuery&   InQuery,
+	                                   const FNavAgentProperties& InAgentProperties,
+	                                   EPathFindingMode::Type     InMode)
+	    : WorldContext(InWorldContext)
+	    , Query(InQuery)
+	    , AgentProperties(InAgentProperties)
+	    , Mode(InMode)
+	{
+	}
+
+	FFindPathAwaiter::~FFindPathAwaiter()
+	{
+		if ( QueryID == INVALID_NAVQUERYID )
+		{
+			return;
+		}
+
+		// 探索中に破棄されたので中断する
+		// ワーカーで実行中の場合は結果が返ってくるがAwaiterが見つからないので無視される
+		GPendingPathQueries.Remove(QueryID);
+		if ( UNavigationSystemV1* NavigationSystem = NavSys.Get() )
+		{
+			NavigationSystem->AbortAsyncFindPathRequest(QueryID);
+		}
+		QueryID = INVALID_NAVQUERYID;
+	}
+
+	bool FFindPathAwaiter::await_suspend(std::coroutine_handle<> coroutine)
+	{
+		check(IsInGameThread());
+
+		UNavigationSystemV1* NavigationSystem =
+		    FNavigationSystem::GetCurrent<UNavigationSystemV1>(WorldContext.Get());
+		UUncoScheduler* OwnerScheduler = UUncoScheduler::Get(WorldContext.Get());
+		if ( NavigationSystem == nullptr || !IsValid(OwnerScheduler) )
+		{
+			Result.Result = ENavigationQueryResult::Error;
+			return false;
+		}
+
+		UNCO_LLM_SCOPE();
+
+		Coroutine = coroutine;
+		NavSys    = NavigationSystem;
+		Scheduler = OwnerScheduler;
+
+		// デリゲートはAwaiterを直接参照せず、クエリIDから検索する
+		QueryID = NavigationSystem->FindPathAsync(
+		    AgentProperties,
+		    Query,
+		    FNavPathQueryDelegate::CreateStatic(&FFindPathAwaiter::OnPathFound),
+		    Mode);
+		if ( QueryID == INVALID_NAVQUERYID )
+		{
+			Result.Result = ENavigationQueryResult::Error;
+			return false;
+		}
+
+		GPendingPathQueries.Add(QueryID, this);
+		return true;
+	}
+
+	void FFindPathAwaiter::OnPathFound(uint32                       InQueryID,
+	                                   ENavigationQueryResult::Type InResult,
+	                                   FNavPathSharedPtr            InPath)
+	{
+		FFindPathAwaiter* Awaiter = nullptr;
+		if ( !GPendingPathQueries.RemoveAndCopyValue(InQueryID, Awaiter) )
+		{
+			// 中断済み
+			return;
+		}
+
+		Awaiter->QueryID       = INVALID_NAVQUERYID;
+		Awaiter->Result.Result = InResult;
+		Awaiter->Result.Path   = MoveTemp(InPath);
+
+		// ワールドコンテキストが破棄された場合は再開しない
+		// コルーチンはホストの破棄と共に破棄される
+		if ( !Awaiter->WorldContext.IsValid() )
+		{
+			return;
+		}
+
+		// ナビゲーションシステムのコールスタック上では再開しない
+		if ( UUncoScheduler* OwnerScheduler = Awaiter->Scheduler.Get() )
+		{
+			OwnerScheduler->ScheduleResume(*Awaiter);
+		}
+	}
+
+} // namespace unco::details
+
+namespace unco
+{
+
+	details::FFindPathAwaiter AsyncFindPath(const UObject*             WorldContextObject,
+	                                        const FPathFindingQuery&   Query,
+	                                        const FNavAgentProperties& AgentProperties,
+	                                        EPathFindingMode::Type     Mode)
+	{
+		return details::FFindPathAwaiter(WorldContextObject, Query, AgentProperties, Mode);
+	}
+
+} // namespace unco
+
+#endif // UNCO_WITH_NAVIGATION
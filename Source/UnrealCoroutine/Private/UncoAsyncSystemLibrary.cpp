@@ -2,81 +2,38 @@
 
 #include "UncoAsyncSystemLibrary.h"
 
-#include "Engine/LatentActionManager.h"
 #include "Engine/StreamableManager.h"
-#include "Kismet/KismetSystemLibrary.h"
-#include "LatentActions.h"
 #include "UObject/WeakObjectPtr.h"
+#include "UncoMemory.h"
 
 namespace unco::details
 {
 
-	////////////////////////////////////////////////////////
-	// FLoadAssetAwaiterBase
-
-	/**
- * @KismetSystemLibrary.cpp
- * FLoadAssetActionBaseから引用
- */
-	class FLoadAssetAwaiterBase::FDelayAction : public FPendingLatentAction
+	TSharedPtr<FStreamableHandle> RequestAsyncLoad(const FSoftObjectPath& Asset)
 	{
-	public:
-		FSoftObjectPath               SoftObjectPath;
-		FStreamableManager            StreamableManager;
-		TSharedPtr<FStreamableHandle> Handle;
-
-		FLoadAssetAwaiterBase*  Awaiter;
-		std::coroutine_handle<> CoroutineHandle;
-
-		FDelayAction(const FSoftObjectPath&  InSoftObjectPath,
-		             FLoadAssetAwaiterBase*  InAwaiter,
-		             std::coroutine_handle<> InCoroutineHandle)
-		    : SoftObjectPath(InSoftObjectPath)
-		    , StreamableManager()
-		    , Handle()
-		    , Awaiter(InAwaiter)
-		    , CoroutineHandle(InCoroutineHandle)
-		{
-			Handle = StreamableManager.RequestAsyncLoad(SoftObjectPath);
-		}
+		UNCO_LLM_SCOPE();
 
-		~FDelayAction()
-		{
-			if ( Handle.IsValid() )
-			{
-				Handle->ReleaseHandle();
-			}
-		}
+		// Awaiter毎にFStreamableManagerを作らずに共有する
+		static FStreamableManager StreamableManager;
+		return StreamableManager.RequestAsyncLoad(Asset);
+	}
 
-		virtual void UpdateOperation(FLatentResponse& Response) override
-		{
-			const bool bLoaded = !Handle.IsValid() || Handle->HasLoadCompleted() ||
-			                     Handle->WasCanceled();
-			if ( bLoaded && Awaiter )
-			{
-				UObject* LoadedObject = SoftObjectPath.ResolveObject();
-				Awaiter->ResultObject = LoadedObject;
-				// コルーチンを再開
-				CoroutineHandle.resume();
-			}
-			Response.DoneIf(bLoaded);
-		}
-	};
+	////////////////////////////////////////////////////////
+	// FLoadAssetAwaiterBase
 
 	FLoadAssetAwaiterBase::FLoadAssetAwaiterBase(const UObject*  InWorldContext,
 	                                             FSoftObjectPath InAsset)
 	    : WorldContext(InWorldContext)
 	    , Asset(InAsset)
-	    , Action()
 	{
 	}
+
 	FLoadAssetAwaiterBase::~FLoadAssetAwaiterBase()
 	{
-		if ( Action )
+		if ( Handle.IsValid() )
 		{
-			Action->Awaiter = nullptr;
+			Handle->ReleaseHandle();
 		}
-		Action = nullptr;
 	}
 
 	bool FLoadAssetAwaiterBase::await_ready() const noexcept
@@ -87,170 +44,81 @@ namespace unco::details
 		return bResult;
 	}
 
-	void FLoadAssetAwaiterBase::await_suspend(std::coroutine_handle<> coroutine)
+	bool FLoadAssetAwaiterBase::await_suspend(std::coroutine_handle<> coroutine)
 	{
-		UWorld* World = GEngine->GetWorldFromContextObject(
-		    WorldContext.Get(), EGetWorldErrorMode::LogAndReturnNull);
-		if ( !IsValid(World) )
+		if ( !SuspendOnTick(WorldContext.Get(), coroutine, &FLoadAssetAwaiterBase::OnTickLoad) )
 		{
-			return;
+			return false;
 		}
-		FLatentActionManager& LatentManager = World->GetLatentActionManager();
 
-		UObject* CallbackTarget = WorldContext.Get();
-		// 識別用のUUIDをthisポインタから作成する
-		const intptr_t uuidptr = reinterpret_cast<intptr_t>(this);
-		const int32    UUID    = static_cast<int32>(uuidptr);
+		UNCO_LLM_SCOPE();
 
 		// We always spawn a new load even if this node already queued one, the outside node handles this case
-		FDelayAction* NewAction = new FDelayAction(Asset, this, coroutine);
-		LatentManager.AddNewAction(CallbackTarget, UUID, NewAction);
+		Handle = RequestAsyncLoad(Asset);
+		return true;
 	}
 
-	////////////////////////////////////////////////////////
-	// FDelayAwaiter
-
-	class FDelayAwaiter::FDelayAction : public FPendingLatentAction
+	bool FLoadAssetAwaiterBase::OnTickLoad(FTickWaitNode& Node, float DeltaTime)
 	{
-	public:
-		FDelayAwaiter*          Awaiter;
-		std::coroutine_handle<> CoroutineHandle;
-		FWeakObjectPtr          CallbackTarget;
-		float                   TimeRemaining;
-
-		FDelayAction(FDelayAwaiter*          InAwaiter,
-		             std::coroutine_handle<> InCoroutineHandle,
-		             UObject*                CallbackTarget,
-		             float                   Duration)
-		    : Awaiter(InAwaiter)
-		    , CoroutineHandle(InCoroutineHandle)
-		    , CallbackTarget(CallbackTarget)
-		    , TimeRemaining(Duration)
-		{
-		}
+		FLoadAssetAwaiterBase& Self = static_cast<FLoadAssetAwaiterBase&>(Node);
 
-		virtual void UpdateOperation(FLatentResponse& Response) override
+		const bool bLoaded = !Self.Handle.IsValid() || Self.Handle->HasLoadCompleted() ||
+		                     Self.Handle->WasCanceled();
+		if ( bLoaded )
 		{
-			TimeRemaining -= Response.ElapsedTime();
-			const bool bFinish = TimeRemaining <= 0.0f;
-			if ( bFinish && Awaiter )
-			{
-				// コルーチンを再開する
-				CoroutineHandle.resume();
-			}
-			Response.DoneIf(bFinish);
+			Self.ResultObject = Self.Asset.ResolveObject();
 		}
-	};
+		return bLoaded;
+	}
+
+	////////////////////////////////////////////////////////
+	// FDelayAwaiter
 
-	FDelayAwaiter::FDelayAwaiter(UObject* InWorldContext, float InDuration)
+	FDelayAwaiter::FDelayAwaiter(UObject* InWorldContext, float InDuration, float InLatenessTolerance)
 	    : WorldContext(InWorldContext)
-	    , Duration(InDuration)
-	    , Action()
+	    , TimeRemaining(InDuration)
 	{
+		LatenessTolerance = InLatenessTolerance;
 	}
 
-	FDelayAwaiter::~FDelayAwaiter()
+	bool FDelayAwaiter::await_ready() const noexcept
 	{
-		if ( Action )
-		{
-			Action->Awaiter = nullptr;
-		}
-		Action = nullptr;
+		// 有効期限がある場合には中断をする
+		return TimeRemaining <= 0.f;
 	}
 
-	bool FDelayAwaiter::await_ready() const noexcept
+	bool FDelayAwaiter::await_suspend(std::coroutine_handle<> coroutine)
 	{
-		// 有効期限がある場合には中断をする
-		return Duration <= 0.f;
+		return SuspendOnTick(WorldContext.Get(), coroutine, &FDelayAwaiter::OnTickDelay);
 	}
 
-	void FDelayAwaiter::await_suspend(std::coroutine_handle<> coroutine)
+	bool FDelayAwaiter::OnTickDelay(FTickWaitNode& Node, float DeltaTime)
 	{
-		UObject* CallbackTarget = WorldContext.Get();
-		// 識別用のUUIDをthisポインタから作成する
-		const intptr_t uuidptr = reinterpret_cast<intptr_t>(this);
-		const int32    UUID    = static_cast<int32>(uuidptr);
-
-		UWorld* World = GEngine->GetWorldFromContextObject(
-		    CallbackTarget, EGetWorldErrorMode::LogAndReturnNull);
-		if ( !IsValid(World) )
-		{
-			return;
-		}
-		FLatentActionManager& LatentActionManager = World->GetLatentActionManager();
-		if ( LatentActionManager.FindExistingAction<FDelayAction>(CallbackTarget,
-		                                                          UUID) == nullptr )
-		{
-			Action = new FDelayAction(this, coroutine, CallbackTarget, Duration);
-			LatentActionManager.AddNewAction(CallbackTarget, UUID, Action);
-		}
+		FDelayAwaiter& Self = static_cast<FDelayAwaiter&>(Node);
+		Self.TimeRemaining -= DeltaTime;
+		return Self.TimeRemaining <= 0.f;
 	}
 
 	////////////////////////////////////////////////////////
 	// FDelayUntilNextTickAwaiter
 
-	class FDelayUntilNextTickAwaiter::FDelayAction : public FPendingLatentAction
-	{
-	public:
-		FDelayUntilNextTickAwaiter* Awaiter;
-		std::coroutine_handle<>     CoroutineHandle;
-		FWeakObjectPtr              CallbackTarget;
-
-		FDelayAction(FDelayUntilNextTickAwaiter* InAwaiter,
-		             std::coroutine_handle<>     InCoroutineHandle,
-		             UObject*                    CallbackTarget)
-		    : Awaiter(InAwaiter)
-		    , CoroutineHandle(InCoroutineHandle)
-		    , CallbackTarget(CallbackTarget)
-		{
-		}
-
-		virtual void UpdateOperation(FLatentResponse& Response) override
-		{
-			if ( Awaiter )
-			{
-				// コルーチンを再開する
-				CoroutineHandle.resume();
-			}
-			Response.DoneIf(true);
-		}
-	};
-
 	FDelayUntilNextTickAwaiter::FDelayUntilNextTickAwaiter(UObject* InWorldContext)
 	    : WorldContext(InWorldContext)
-	    , Action()
 	{
 	}
 
-	FDelayUntilNextTickAwaiter::~FDelayUntilNextTickAwaiter()
+	bool FDelayUntilNextTickAwaiter::await_suspend(std::coroutine_handle<> coroutine)
 	{
-		if ( Action )
-		{
-			Action->Awaiter = nullptr;
-		}
-		Action = nullptr;
+		SuspendFrame = GFrameCounter;
+		return SuspendOnTick(
+		    WorldContext.Get(), coroutine, &FDelayUntilNextTickAwaiter::OnTickNextFrame);
 	}
 
-	void FDelayUntilNextTickAwaiter::await_suspend(std::coroutine_handle<> coroutine)
+	bool FDelayUntilNextTickAwaiter::OnTickNextFrame(FTickWaitNode& Node, float DeltaTime)
 	{
-		UObject* CallbackTarget = WorldContext.Get();
-		// 識別用のUUIDをthisポインタから作成する
-		const intptr_t uuidptr = reinterpret_cast<intptr_t>(this);
-		const int32    UUID    = static_cast<int32>(uuidptr);
-
-		UWorld* World = GEngine->GetWorldFromContextObject(
-		    CallbackTarget, EGetWorldErrorMode::LogAndReturnNull);
-		if ( !IsValid(World) )
-		{
-			return;
-		}
-		FLatentActionManager& LatentActionManager = World->GetLatentActionManager();
-		if ( LatentActionManager.FindExistingAction<FDelayAction>(CallbackTarget,
-		                                                          UUID) == nullptr )
-		{
-			Action = new FDelayAction(this, coroutine, CallbackTarget);
-			LatentActionManager.AddNewAction(CallbackTarget, UUID, Action);
-		}
+		// スケジューラーのTickより前に待機した場合でも同じフレームでは再開しない
+		const FDelayUntilNextTickAwaiter& Self = static_cast<FDelayUntilNextTickAwaiter&>(Node);
+		return GFrameCounter != Self.SuspendFrame;
 	}
 
 	////////////////////////////////////////////////////////
@@ -259,23 +127,14 @@ namespace unco::details
 	FTimerAwaiter::FTimerAwaiter(UObject* InWorldContext,
 	                             float    InTime,
 	                             float    InitialStartDelay,
-	                             float    InitialStartDelayVariance)
+	                             float    InitialStartDelayVariance,
+	                             float    InLatenessTolerance)
 	    : WorldContext(InWorldContext)
-	    , TimerHandle()
 	    , Time(InTime)
 	    , InitialStartDelay(InitialStartDelay)
 	    , InitialStartDelayVariance(InitialStartDelayVariance)
 	{
-	}
-
-	FTimerAwaiter::~FTimerAwaiter()
-	{
-		// タイマーハンドルが有効の場合にはまだ完了していないので削除処理が必要
-		if ( TimerHandle.IsValid() && WorldContext.IsValid() )
-		{
-			UWorld* world = WorldContext->GetWorld();
-			world->GetTimerManager().ClearTimer(TimerHandle);
-		}
+		LatenessTolerance = InLatenessTolerance;
 	}
 
 	bool FTimerAwaiter::await_ready() const noexcept
@@ -284,30 +143,21 @@ namespace unco::details
 		return Time == 0;
 	}
 
-	void FTimerAwaiter::await_suspend(std::coroutine_handle<> coroutine)
+	bool FTimerAwaiter::await_suspend(std::coroutine_handle<> coroutine)
 	{
-		const UWorld* World =
-		    WorldContext.IsValid() ? WorldContext->GetWorld() : nullptr;
-		if ( !IsValid(World) )
-		{
-			return;
-		}
-
+		// FTimerManager::SetTimerと同じく初回の待機時間にのみ遅延を加える
 		InitialStartDelay +=
 		    FMath::RandRange(-InitialStartDelayVariance, InitialStartDelayVariance);
+		TimeRemaining = Time + InitialStartDelay;
 
-		const auto OnDelayFinish = [this, coroutine]()
-		{
-			// タイマーハンドルを無効値にする
-			TimerHandle.Invalidate();
-
-			// コルーチンを再開する
-			coroutine.resume();
-		};
+		return SuspendOnTick(WorldContext.Get(), coroutine, &FTimerAwaiter::OnTickTimer);
+	}
 
-		FTimerManager& TimerManager = World->GetTimerManager();
-		TimerManager.SetTimer(
-		    TimerHandle, OnDelayFinish, Time, false, (Time + InitialStartDelay));
+	bool FTimerAwaiter::OnTickTimer(FTickWaitNode& Node, float DeltaTime)
+	{
+		FTimerAwaiter& Self = static_cast<FTimerAwaiter&>(Node);
+		Self.TimeRemaining -= DeltaTime;
+		return Self.TimeRemaining <= 0.f;
 	}
 
 } // namespace unco::details
@@ -315,9 +165,10 @@ namespace unco::details
 namespace unco
 {
 	unco::details::FDelayAwaiter AsyncDelay(UObject* WorldContextObject,
-	                                        float    Duration)
+	                                        float    Duration,
+	                                        float    LatenessTolerance)
 	{
-		return details::FDelayAwaiter(WorldContextObject, Duration);
+		return details::FDelayAwaiter(WorldContextObject, Duration, LatenessTolerance);
 	}
 
 	unco::details::FDelayUntilNextTickAwaiter DelayUntilNextTick(
@@ -329,10 +180,11 @@ namespace unco
 	unco::details::FTimerAwaiter AsyncSetTimer(UObject* InWorldContext,
 	                                           float    Time,
 	                                           float    InitialStartDelay,
-	                                           float    InitialStartDelayVariance)
+	                                           float    InitialStartDelayVariance,
+	                                           float    LatenessTolerance)
 	{
 		return details::FTimerAwaiter(
-		    InWorldContext, Time, InitialStartDelay, InitialStartDelayVariance);
+		    InWorldContext, Time, InitialStartDelay, InitialStartDelayVariance, LatenessTolerance);
 	}
 
 } // namespace unco
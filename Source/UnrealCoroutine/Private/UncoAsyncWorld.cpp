@@ -0,0 +1,252 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "UncoAsyncWorld.h"
+
+#include "Engine/World.h"
+#include "UncoMemory.h"
+#include "UnrealCoroutine.h"
+
+DECLARE_CYCLE_STAT(TEXT("Unco_AsyncTrace"), STAT_AsyncTrace, STATGROUP_Unco);
+
+namespace unco::details
+{
+
+	////////////////////////////////////////////////////////
+	// FAsyncTraceAwaiterBase
+
+	FAsyncTraceAwaiterBase::FAsyncTraceAwaiterBase(
+	    const UObject*                  InWorldContext,
+	    TArray<FTraceRequest>           InRequests,
+	    ECollisionChannel               InChannel,
+	    const FCollisionQueryParams&    InParams,
+	    const FCollisionResponseParams& InResponseParams,
+	    EAsyncTraceType                 InTraceType)
+	    : World(GEngine->GetWorldFromContextObject(InWorldContext,
+	                                               EGetWorldErrorMode::LogAndReturnNull))
+	    , Requests(MoveTemp(InRequests))
+	    , Params(InParams)
+	    , ResponseParams(InResponseParams)
+	    , Channel(InChannel)
+	    , TraceType(InTraceType)
+	{
+	}
+
+	bool FAsyncTraceAwaiterBase::await_suspend(std::coroutine_handle<> coroutine)
+	{
+		UWorld*         TraceWorld = World.Get();
+		UUncoScheduler* Scheduler  = UUncoScheduler::Get(TraceWorld);
+		if ( !IsValid(TraceWorld) || !IsValid(Scheduler) || Requests.Num() == 0 )
+		{
+			Results.SetNum(Requests.Num());
+			return false;
+		}
+
+		SCOPE_CYCLE_COUNTER(STAT_AsyncTrace);
+		UNCO_LLM_SCOPE();
+
+		// 非同期トレースキューに積む
+		// デリゲートは使わず次フレームにハンドルで結果を取得する
+		Handles.Reserve(Requests.Num());
+		for ( const FTraceRequest& Request : Requests )
+		{
+			if ( Request.Shape.IsLine() )
+			{
+				Handles.Add(TraceWorld->AsyncLineTraceByChannel(TraceType,
+				                                                Request.Start,
+				                                                Request.End,
+				                                                Channel,
+				                                                Params,
+				                                                ResponseParams));
+			}
+			else
+			{
+				Handles.Add(TraceWorld->AsyncSweepByChannel(TraceType,
+				                                            Request.Start,
+				                                            Request.End,
+				                                            Request.Rot,
+				                                            Channel,
+				                                            Request.Shape,
+				                                            Params,
+				                                            ResponseParams));
+			}
+		}
+		Results.SetNum(Requests.Num());
+		NumPending = Handles.Num();
+
+		Coroutine = coroutine;
+		OnTick    = &FAsyncTraceAwaiterBase::OnTickTrace;
+		Scheduler->AddTickWaiter(*this);
+		return true;
+	}
+
+	bool FAsyncTraceAwaiterBase::OnTickTrace(FTickWaitNode& Node, float DeltaTime)
+	{
+		FAsyncTraceAwaiterBase& Self       = static_cast<FAsyncTraceAwaiterBase&>(Node);
+		UWorld*                 TraceWorld = Self.World.Get();
+		if ( !IsValid(TraceWorld) )
+		{
+			// ワールドが破棄されたので取得出来た所までで再開する
+			return true;
+		}
+
+		FTraceDatum Datum;
+		for ( int32 Index = 0; Index < Self.Handles.Num(); ++Index )
+		{
+			FTraceHandle& Handle = Self.Handles[Index];
+			if ( !Handle.IsValid() )
+			{
+				// 取得済み
+				continue;
+			}
+			if ( TraceWorld->QueryTraceData(Handle, Datum) )
+			{
+				Self.Results[Index] = MoveTemp(Datum.OutHits);
+			}
+			else if ( TraceWorld->IsTraceHandleValid(Handle, false) )
+			{
+				// まだ結果が揃っていない
+				continue;
+			}
+			Handle.Invalidate();
+			--Self.NumPending;
+		}
+		return Self.NumPending <= 0;
+	}
+
+	////////////////////////////////////////////////////////
+	// FAsyncOverlapAwaiter
+
+	FAsyncOverlapAwaiter::FAsyncOverlapAwaiter(
+	    const UObject*                  InWorldContext,
+	    const FVector&                  InPos,
+	    const FQuat&                    InRot,
+	    ECollisionChannel               InChannel,
+	    const FCollisionShape&          InShape,
+	    const FCollisionQueryParams&    InParams,
+	    const FCollisionResponseParams& InResponseParams)
+	    : World(GEngine->GetWorldFromContextObject(InWorldContext,
+	                                               EGetWorldErrorMode::LogAndReturnNull))
+	    , Pos(InPos)
+	    , Rot(InRot)
+	    , Shape(InShape)
+	    , Params(InParams)
+	    , ResponseParams(InResponseParams)
+	    , Channel(InChannel)
+	{
+	}
+
+	bool FAsyncOverlapAwaiter::await_suspend(std::coroutine_handle<> coroutine)
+	{
+		UWorld*         TraceWorld = World.Get();
+		UUncoScheduler* Scheduler  = UUncoScheduler::Get(TraceWorld);
+		if ( !IsValid(TraceWorld) || !IsValid(Scheduler) )
+		{
+			return false;
+		}
+
+		SCOPE_CYCLE_COUNTER(STAT_AsyncTrace);
+
+		Handle = TraceWorld->AsyncOverlapByChannel(
+		    Pos, Rot, Channel, Shape, Params, ResponseParams);
+
+		Coroutine = coroutine;
+		OnTick    = &FAsyncOverlapAwaiter::OnTickOverlap;
+		Scheduler->AddTickWaiter(*this);
+		return true;
+	}
+
+	bool FAsyncOverlapAwaiter::OnTickOverlap(FTickWaitNode& Node, float DeltaTime)
+	{
+		FAsyncOverlapAwaiter& Self       = static_cast<FAsyncOverlapAwaiter&>(Node);
+		UWorld*               TraceWorld = Self.World.Get();
+		if ( !IsValid(TraceWorld) )
+		{
+			return true;
+		}
+
+		FOverlapDatum Datum;
+		if ( TraceWorld->QueryOverlapData(Self.Handle, Datum) )
+		{
+			Self.Result = MoveTemp(Datum.OutOverlaps);
+			return true;
+		}
+		// ハンドルが無効になっている場合は結果が失われている
+		return !TraceWorld->IsTraceHandleValid(Self.Handle, true);
+	}
+
+} // namespace unco::details
+
+namespace unco
+{
+
+	details::FAsyncTraceAwaiter AsyncLineTrace(const UObject*                  WorldContextObject,
+	                                           const FVector&                  Start,
+	                                           const FVector&                  End,
+	                                           ECollisionChannel               Channel,
+	                                           const FCollisionQueryParams&    Params,
+	                                           const FCollisionResponseParams& ResponseParams,
+	                                           EAsyncTraceType                 TraceType)
+	{
+		FTraceRequest Request;
+		Request.Start = Start;
+		Request.End   = End;
+		return details::FAsyncTraceAwaiter(WorldContextObject,
+		                                   TArray<FTraceRequest>{Request},
+		                                   Channel,
+		                                   Params,
+		                                   ResponseParams,
+		                                   TraceType);
+	}
+
+	details::FAsyncTraceAwaiter AsyncSweep(const UObject*                  WorldContextObject,
+	                                       const FVector&                  Start,
+	                                       const FVector&                  End,
+	                                       const FQuat&                    Rot,
+	                                       ECollisionChannel               Channel,
+	                                       const FCollisionShape&          Shape,
+	                                       const FCollisionQueryParams&    Params,
+	                                       const FCollisionResponseParams& ResponseParams,
+	                                       EAsyncTraceType                 TraceType)
+	{
+		FTraceRequest Request;
+		Request.Start = Start;
+		Request.End   = End;
+		Request.Rot   = Rot;
+		Request.Shape = Shape;
+		return details::FAsyncTraceAwaiter(WorldContextObject,
+		                                   TArray<FTraceRequest>{Request},
+		                                   Channel,
+		                                   Params,
+		                                   ResponseParams,
+		                                   TraceType);
+	}
+
+	details::FAsyncOverlapAwaiter AsyncOverlap(const UObject*                  WorldContextObject,
+	                                           const FVector&                  Pos,
+	                                           const FQuat&                    Rot,
+	                                           ECollisionChannel               Channel,
+	                                           const FCollisionShape&          Shape,
+	                                           const FCollisionQueryParams&    Params,
+	                                           const FCollisionResponseParams& ResponseParams)
+	{
+		return details::FAsyncOverlapAwaiter(
+		    WorldContextObject, Pos, Rot, Channel, Shape, Params, ResponseParams);
+	}
+
+	details::FAsyncTraceBatchAwaiter AsyncTraceBatch(
+	    const UObject*                  WorldContextObject,
+	    TArray<FTraceRequest>           Requests,
+	    ECollisionChannel               Channel,
+	    const FCollisionQueryParams&    Params,
+	    const FCollisionResponseParams& ResponseParams,
+	    EAsyncTraceType                 TraceType)
+	{
+		return details::FAsyncTraceBatchAwaiter(WorldContextObject,
+		                                        MoveTemp(Requests),
+		                                        Channel,
+		                                        Params,
+		                                        ResponseParams,
+		                                        TraceType);
+	}
+
+} // namespace unco
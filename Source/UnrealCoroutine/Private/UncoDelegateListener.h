@@ -0,0 +1,37 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "UncoDelegateListener.generated.h"
+
+namespace unco::details
+{
+	class FDynamicDelegateWaitList;
+}
+
+/**
+ * @brief ダイナミックマルチキャストデリゲートの受信用オブジェクト
+ *
+ * ProcessEventを横取りしてブロードキャストの引数バッファを待機リストへ渡す。
+ * その為シグネチャに関わらず任意のダイナミックデリゲートにバインド出来る。
+ */
+UCLASS(Transient)
+class UUncoDelegateListener : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	// バインド用の関数
+	// ProcessEventで横取りする為実際には呼ばれない
+	UFUNCTION()
+	void OnBroadcast();
+
+	// Begin UObject
+	virtual void ProcessEvent(UFunction* Function, void* Parms) override;
+	// End UObject
+
+	// 通知先の待機リスト
+	unco::details::FDynamicDelegateWaitList* WaitList = nullptr;
+};
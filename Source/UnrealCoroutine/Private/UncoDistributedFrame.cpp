@@ -0,0 +1,138 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "UncoDistributedFrame.h"
+
+#include "UncoMemory.h"
+#include "UncoTrace.h"
+#if UNCO_WATCHDOG_ENABLED
+	#include "UncoWatchdog.h"
+#endif
+
+namespace unco::details
+{
+
+	int32 StepDistributedFrame(FDistributedFrameInfo& FrameInfo, const FFrameBudget& Budget)
+	{
+		FObjectGenerator& Generator = FrameInfo.Generator;
+
+		// 時間を指定していない場合は時計を読まない
+		const uint64 StartCycles = Budget.TimeMs > 0.f ? FPlatformTime::Cycles64() : 0;
+
+		// このフレームで使用出来るコスト
+		int32 RemainingCost = Budget.CostUnits;
+		if ( Budget.CostUnits > 0 && FrameInfo.bCarryOver )
+		{
+			RemainingCost += FrameInfo.CarriedCost;
+		}
+
+		// このフレームで実行出来る回数
+		int32 StepLimit = Budget.Count;
+		if ( Budget.Count > 0 && FrameInfo.bCarryOver )
+		{
+			StepLimit += FrameInfo.CarriedCount;
+		}
+
+		// 前のフレームの超過分で使い切っている場合はこのフレームは実行しない
+		bool  bContinue = Budget.CostUnits <= 0 || RemainingCost > 0;
+		int32 Steps     = 0;
+		while ( bContinue && !Generator.Done() )
+		{
+			// コルーチンの内部処理を実行
+#if UNCO_WATCHDOG_ENABLED
+			const uint64 StepStartCycles = IsSliceWatchdogEnabled() ? FPlatformTime::Cycles64() : 0;
+#endif
+			Generator.MoveNext();
+#if UNCO_WATCHDOG_ENABLED
+			if ( StepStartCycles != 0 )
+			{
+				const uint64 StepCycles = FPlatformTime::Cycles64() - StepStartCycles;
+				if ( StepCycles > GSliceThresholdCycles )
+				{
+					ReportLongGeneratorStep(Generator.GetHostObject(), StepCycles);
+				}
+			}
+#endif
+			++Steps;
+
+			// co_yieldした値をこのステップのコストとして消費する
+			if ( Budget.CostUnits > 0 )
+			{
+				RemainingCost -= FMath::Max(Generator.GetYieldedValue(), 1);
+				bContinue = RemainingCost > 0;
+			}
+			if ( Budget.Count > 0 && Steps >= StepLimit )
+			{
+				bContinue = false;
+			}
+			if ( bContinue && Budget.TimeMs > 0.f )
+			{
+				const double ElapsedMs = FPlatformTime::ToMilliseconds64(
+				    FPlatformTime::Cycles64() - StartCycles);
+				bContinue = ElapsedMs < Budget.TimeMs;
+			}
+		}
+
+		// 超過分・未使用分を次のフレームに持ち越す
+		// 未使用分は回数・時間の制限で打ち切られた場合に発生するので1フレーム分までに制限する
+		if ( Budget.CostUnits > 0 && FrameInfo.bCarryOver )
+		{
+			FrameInfo.CarriedCost = FMath::Min(RemainingCost, Budget.CostUnits);
+		}
+		if ( Budget.Count > 0 && FrameInfo.bCarryOver )
+		{
+			FrameInfo.CarriedCount = FMath::Min(StepLimit - Steps, Budget.Count);
+		}
+		return Steps;
+	}
+
+	void FDistributedFrameList::Add(FObjectGenerator&& Generator, const FFrameBudget& Budget, bool bCarryOver)
+	{
+		UNCO_LLM_SCOPE();
+
+		if ( bRunning )
+		{
+			// 実行中に追加はさせたくないので遅延で追加させる
+			DelayedEntries.Emplace(std::move(Generator), Budget, bCarryOver);
+		}
+		else
+		{
+			Entries.Emplace(std::move(Generator), Budget, bCarryOver);
+		}
+	}
+
+	void FDistributedFrameList::Empty()
+	{
+		Entries.Empty();
+		DelayedEntries.Empty();
+	}
+
+	void FDistributedFrameList::Compact()
+	{
+		// 分散フレームが終了したものを削除
+		Entries.RemoveAll(
+		    [&](const FDistributedFrameInfo& Cache)
+		    {
+			    // コルーチンが終了した物
+			    if ( Cache.Generator.Done() )
+			    {
+				    return true;
+			    }
+			    // 呼び出し元のオブジェクトが破棄されたか？
+			    if ( !Cache.Generator.IsValidObject() )
+			    {
+				    return true;
+			    }
+
+			    return false;
+		    });
+
+		// コルーチン実行中に追加された物はループ後に追加する
+		for ( FDistributedFrameInfo& Info : DelayedEntries )
+		{
+			Entries.Emplace(std::move(Info));
+		}
+
+		DelayedEntries.Empty();
+	}
+
+} // namespace unco::details
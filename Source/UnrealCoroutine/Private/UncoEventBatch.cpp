@@ -0,0 +1,79 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "UncoEventBatch.h"
+
+namespace unco::details
+{
+
+	////////////////////////////////////////////////////////
+	// FEventBatchAwaiterBase
+
+	FEventBatchAwaiterBase::FEventBatchAwaiterBase(const UObject*   InWorldContext,
+	                                               FEventQueueBase& InQueue,
+	                                               EMode            InMode,
+	                                               float            InInterval)
+	    : WorldContext(InWorldContext)
+	    , Queue(InQueue)
+	    , Interval(InInterval)
+	    , Mode(InMode)
+	{
+	}
+
+	bool FEventBatchAwaiterBase::await_suspend(std::coroutine_handle<> coroutine)
+	{
+		LastPushCount = Queue.PushCount;
+		QuietTime     = 0.f;
+		if ( SuspendOnTick(WorldContext.Get(), coroutine, &FEventBatchAwaiterBase::OnTickBatch) )
+		{
+			if ( Mode == EMode::Throttle )
+			{
+				Scheduler = UUncoScheduler::Get(WorldContext.Get());
+			}
+			return true;
+		}
+
+		// スケジューラーが無い場合は中断せずに溜まっているイベント(空の場合もある)を返す
+		return false;
+	}
+
+	void FEventBatchAwaiterBase::OnBatchTaken()
+	{
+		if ( const UUncoScheduler* OwnerScheduler = Scheduler.Get() )
+		{
+			Queue.LastBatchTime = OwnerScheduler->GetTimeSeconds();
+		}
+	}
+
+	bool FEventBatchAwaiterBase::OnTickBatch(FTickWaitNode& Node, float DeltaTime)
+	{
+		FEventBatchAwaiterBase& Self = static_cast<FEventBatchAwaiterBase&>(Node);
+
+		switch ( Self.Mode )
+		{
+			case EMode::EveryFrame:
+				return !Self.Queue.IsEmpty();
+
+			case EMode::Debounce:
+				// イベントが追加されたフレームは経過時間をやり直す
+				if ( Self.Queue.PushCount != Self.LastPushCount )
+				{
+					Self.LastPushCount = Self.Queue.PushCount;
+					Self.QuietTime     = 0.f;
+					return false;
+				}
+				Self.QuietTime += DeltaTime;
+				return !Self.Queue.IsEmpty() && Self.QuietTime >= Self.Interval;
+
+			case EMode::Throttle:
+			{
+				// ワールドの時間はエンジンのスケジューラーやコマンドレットでは進まないのでスケジューラーの時刻で判定する
+				// 待機していない間も時刻は進むので、前回取り出してからの経過時間は待機の有無に依らない
+				const UUncoScheduler* OwnerScheduler = Self.Scheduler.Get();
+				return !Self.Queue.IsEmpty() && OwnerScheduler != nullptr &&
+				       OwnerScheduler->GetTimeSeconds() - Self.Queue.LastBatchTime >= Self.Interval;
+			}
+		}
+		return true;
+	}
+
+} // namespace unco::details
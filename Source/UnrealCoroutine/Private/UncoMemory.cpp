@@ -0,0 +1,265 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "UncoMemory.h"
+
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformStackWalk.h"
+#include "Misc/ScopeLock.h"
+#include "UnrealCoroutine.h"
+
+LLM_DEFINE_TAG(Unco);
+
+namespace unco::details
+{
+
+	namespace
+	{
+#if UNCO_FRAME_STATS
+
+		TAutoConsoleVariable<int32> CVarFrameSizeWarningThreshold(
+		    TEXT("unco.FrameSizeWarningThreshold"),
+		    2048,
+		    TEXT("コルーチンフレームのサイズがこの値(byte)を超えた場合に警告を出力します。0以下で無効"),
+		    ECVF_Default);
+
+		/**
+		 * @brief フレームの先頭に付与するヘッダー
+		 * 解放時に呼び出し元を特定する為に使用する
+		*/
+		struct alignas(16) FFrameHeader
+		{
+			int32  SiteIndex;
+			uint32 Size;
+		};
+
+		/**
+		 * @brief コルーチン関数毎の記録
+		*/
+		struct FFrameSite
+		{
+			uint64 ProgramCounter   = 0;
+			// 関数名は統計の取得時に解決する(未解決の場合は空)
+			FString CallSite;
+			FName   TagName;
+			uint32  FrameSize        = 0;
+			int32   LiveFrames       = 0;
+			int32   PeakFrames       = 0;
+			uint64  TotalAllocations = 0;
+			bool    bWarned          = false;
+		};
+
+		FCriticalSection      GFrameSiteLock;
+		TMap<uint64, int32>   GFrameSiteIndices;
+		TArray<FFrameSite>    GFrameSites;
+
+		// 呼び出し元のアドレスから関数名を解決する
+		// シンボルの検索は重いのでフレームの確保中やGFrameSiteLockをロックした状態では呼ばない
+		FString ResolveCallSite(uint64 ProgramCounter)
+		{
+			FProgramCounterSymbolInfo SymbolInfo;
+			FPlatformStackWalk::ProgramCounterToSymbolInfo(ProgramCounter, SymbolInfo);
+			if ( SymbolInfo.FunctionName[0] != '\0' )
+			{
+				return ANSI_TO_TCHAR(SymbolInfo.FunctionName);
+			}
+			return FString::Printf(TEXT("0x%016llx"), ProgramCounter);
+		}
+
+		// 呼び出し元の記録を取得する
+		// GFrameSiteLockをロックした状態で呼ぶ事
+		int32 FindOrAddSite(uint64 ProgramCounter)
+		{
+			if ( const int32* Found = GFrameSiteIndices.Find(ProgramCounter) )
+			{
+				return *Found;
+			}
+
+			// LLMのタグはシンボルを検索せずにアドレスで命名する
+			FFrameSite& Site    = GFrameSites.AddDefaulted_GetRef();
+			Site.ProgramCounter = ProgramCounter;
+			Site.TagName        = FName(*FString::Printf(TEXT("Unco/0x%016llx"), ProgramCounter));
+
+			const int32 Index = GFrameSites.Num() - 1;
+			GFrameSiteIndices.Add(ProgramCounter, Index);
+			return Index;
+		}
+
+		// フレームサイズが閾値を超えているか？
+		bool ExceedsFrameSizeThreshold(std::size_t Size)
+		{
+			const int32 Threshold = CVarFrameSizeWarningThreshold.GetValueOnAnyThread();
+			return Threshold > 0 && Size > static_cast<std::size_t>(Threshold);
+		}
+
+		// 閾値を超えたフレームを警告する
+		void WarnFrameSize(uint64 ProgramCounter, std::size_t Size)
+		{
+			UE_LOG(LogUnco,
+			       Warning,
+			       TEXT("Coroutine frame of %s is %llu bytes (threshold %d)"),
+			       *ResolveCallSite(ProgramCounter),
+			       static_cast<uint64>(Size),
+			       CVarFrameSizeWarningThreshold.GetValueOnAnyThread());
+		}
+
+#endif
+
+	} // namespace
+
+	FORCENOINLINE void* AllocateFrame(std::size_t Size)
+	{
+#if UNCO_FRAME_STATS
+		// promise_type::operator newはインライン展開される為
+		// 戻りアドレスはコルーチン関数の内部を指す
+		const uint64 ProgramCounter = reinterpret_cast<uint64>(PLATFORM_RETURN_ADDRESS());
+
+		int32 SiteIndex = INDEX_NONE;
+		FName TagName;
+		bool  bWarn = false;
+		{
+			FScopeLock Lock(&GFrameSiteLock);
+			SiteIndex        = FindOrAddSite(ProgramCounter);
+			FFrameSite& Site = GFrameSites[SiteIndex];
+
+			Site.FrameSize = FMath::Max(Site.FrameSize, static_cast<uint32>(Size));
+			Site.LiveFrames++;
+			Site.PeakFrames = FMath::Max(Site.PeakFrames, Site.LiveFrames);
+			Site.TotalAllocations++;
+			TagName = Site.TagName;
+
+			// 警告は呼び出し元毎に1度だけ行う
+			if ( !Site.bWarned && ExceedsFrameSizeThreshold(Size) )
+			{
+				Site.bWarned = true;
+				bWarn        = true;
+			}
+		}
+
+		if ( bWarn )
+		{
+			WarnFrameSize(ProgramCounter, Size);
+		}
+
+		LLM_SCOPE_BYTAG(Unco);
+		LLM(FLLMScope SiteScope(TagName, false, ELLMTagSet::None, ELLMTracker::Default));
+
+		uint8* Memory = static_cast<uint8*>(
+		    FMemory::Malloc(Size + sizeof(FFrameHeader), alignof(FFrameHeader)));
+		FFrameHeader* Header = reinterpret_cast<FFrameHeader*>(Memory);
+		Header->SiteIndex    = SiteIndex;
+		Header->Size         = static_cast<uint32>(Size);
+		return Memory + sizeof(FFrameHeader);
+#else
+		LLM_SCOPE_BYTAG(Unco);
+		return FMemory::Malloc(Size);
+#endif
+	}
+
+	void FreeFrame(void* Ptr, std::size_t Size) noexcept
+	{
+		if ( Ptr == nullptr )
+		{
+			return;
+		}
+#if UNCO_FRAME_STATS
+		FFrameHeader* Header =
+		    reinterpret_cast<FFrameHeader*>(static_cast<uint8*>(Ptr) - sizeof(FFrameHeader));
+		{
+			FScopeLock Lock(&GFrameSiteLock);
+			if ( GFrameSites.IsValidIndex(Header->SiteIndex) )
+			{
+				GFrameSites[Header->SiteIndex].LiveFrames--;
+			}
+		}
+		FMemory::Free(Header);
+#else
+		FMemory::Free(Ptr);
+#endif
+	}
+
+} // namespace unco::details
+
+namespace unco
+{
+
+	TArray<FCoroutineFrameStats> GetCoroutineFrameStats()
+	{
+		TArray<FCoroutineFrameStats> Result;
+#if UNCO_FRAME_STATS
+		// 関数名が未解決の呼び出し元をロックの外で解決する
+		TArray<TPair<int32, uint64>> Unresolved;
+		{
+			FScopeLock Lock(&details::GFrameSiteLock);
+			for ( int32 Index = 0; Index < details::GFrameSites.Num(); ++Index )
+			{
+				if ( details::GFrameSites[Index].CallSite.IsEmpty() )
+				{
+					Unresolved.Emplace(Index, details::GFrameSites[Index].ProgramCounter);
+				}
+			}
+		}
+		TArray<FString> ResolvedCallSites;
+		ResolvedCallSites.Reserve(Unresolved.Num());
+		for ( const TPair<int32, uint64>& Site : Unresolved )
+		{
+			ResolvedCallSites.Add(details::ResolveCallSite(Site.Value));
+		}
+
+		{
+			FScopeLock Lock(&details::GFrameSiteLock);
+			for ( int32 Index = 0; Index < Unresolved.Num(); ++Index )
+			{
+				details::GFrameSites[Unresolved[Index].Key].CallSite = MoveTemp(ResolvedCallSites[Index]);
+			}
+
+			Result.Reserve(details::GFrameSites.Num());
+			for ( const details::FFrameSite& Site : details::GFrameSites )
+			{
+				FCoroutineFrameStats& Stats = Result.AddDefaulted_GetRef();
+				Stats.CallSite              = Site.CallSite;
+				Stats.FrameSize             = Site.FrameSize;
+				Stats.LiveFrames            = Site.LiveFrames;
+				Stats.PeakFrames            = Site.PeakFrames;
+				Stats.TotalAllocations      = Site.TotalAllocations;
+			}
+		}
+		Result.Sort(
+		    [](const FCoroutineFrameStats& A, const FCoroutineFrameStats& B)
+		    {
+			    return static_cast<uint64>(A.FrameSize) * A.LiveFrames >
+			           static_cast<uint64>(B.FrameSize) * B.LiveFrames;
+		    });
+#endif
+		return Result;
+	}
+
+	void DumpCoroutineFrameStats(FOutputDevice& Ar)
+	{
+		Ar.Logf(TEXT("%10s %8s %8s %12s %12s  %s"),
+		        TEXT("FrameSize"),
+		        TEXT("Live"),
+		        TEXT("Peak"),
+		        TEXT("Total"),
+		        TEXT("LiveBytes"),
+		        TEXT("CallSite"));
+		for ( const FCoroutineFrameStats& Stats : GetCoroutineFrameStats() )
+		{
+			Ar.Logf(TEXT("%10u %8d %8d %12llu %12llu  %s"),
+			        Stats.FrameSize,
+			        Stats.LiveFrames,
+			        Stats.PeakFrames,
+			        Stats.TotalAllocations,
+			        static_cast<uint64>(Stats.FrameSize) * Stats.LiveFrames,
+			        *Stats.CallSite);
+		}
+	}
+
+	namespace
+	{
+		FAutoConsoleCommandWithOutputDevice GDumpFrameStatsCommand(
+		    TEXT("unco.DumpFrameStats"),
+		    TEXT("コルーチン関数毎のフレームサイズと生存数を出力します"),
+		    FConsoleCommandWithOutputDeviceDelegate::CreateStatic(&DumpCoroutineFrameStats));
+	} // namespace
+
+} // namespace unco
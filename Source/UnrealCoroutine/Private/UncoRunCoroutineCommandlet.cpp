@@ -0,0 +1,196 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "UncoRunCoroutineCommandlet.h"
+
+#include "Async/TaskGraphInterfaces.h"
+#include "Containers/Ticker.h"
+#include "HAL/PlatformMemory.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "UObject/UObjectGlobals.h"
+#include "UncoAsyncSystemLibrary.h"
+#include "UncoScheduler.h"
+#include "UncoTaskScope.h"
+#include "UnrealCoroutine.h"
+
+UUncoRunCoroutineCommandlet::UUncoRunCoroutineCommandlet()
+{
+	IsClient       = false;
+	IsServer       = false;
+	IsEditor       = false;
+	LogToConsole   = true;
+	ShowErrorCount = true;
+}
+
+int32 UUncoRunCoroutineCommandlet::Main(const FString& Params)
+{
+	FParse::Value(*Params, TEXT("MaxConcurrency="), MaxConcurrency);
+	FParse::Value(*Params, TEXT("ReportInterval="), ReportInterval);
+	FParse::Value(*Params, TEXT("GCInterval="), GCInterval);
+	MaxConcurrency = FMath::Max(MaxConcurrency, 1);
+
+	// ワールドが無いのでエンジンのスケジューラーで実行される
+	if ( !IsValid(UUncoScheduler::Get(this)) )
+	{
+		UE_LOG(LogUnco, Error, TEXT("The engine coroutine scheduler is not available"));
+		return 1;
+	}
+
+	const double StartTime  = FPlatformTime::Seconds();
+	double       LastTime   = StartTime;
+	double       LastReport = StartTime;
+	int32        LastGC     = 0;
+
+	RunRoot(Params);
+
+	while ( !bFinished && !IsEngineExitRequested() )
+	{
+		const double Now       = FPlatformTime::Seconds();
+		const float  DeltaTime = static_cast<float>(Now - LastTime);
+		LastTime               = Now;
+
+		TickFrame(DeltaTime);
+
+		if ( GCInterval > 0 && NumProcessed - LastGC >= GCInterval )
+		{
+			// ループの間はコルーチンが実行されていないので安全に行える
+			LastGC = NumProcessed;
+			CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+		}
+
+		if ( ReportInterval > 0.f && Now - LastReport >= ReportInterval )
+		{
+			LastReport = Now;
+			ReportProgress(Now - StartTime);
+		}
+	}
+
+	ReportProgress(FPlatformTime::Seconds() - StartTime);
+
+	const FPlatformMemoryStats MemoryStats = FPlatformMemory::GetStats();
+	UE_LOG(LogUnco,
+	       Display,
+	       TEXT("Peak memory: %.1f MB physical, %.1f MB virtual"),
+	       MemoryStats.PeakUsedPhysical / (1024.0 * 1024.0),
+	       MemoryStats.PeakUsedVirtual / (1024.0 * 1024.0));
+
+	return NumFailed > 0 ? 1 : 0;
+}
+
+unco::FObjectTask UUncoRunCoroutineCommandlet::RunCoroutine(FString Params)
+{
+	TArray<FSoftObjectPath> Items;
+	GatherItems(Params, Items);
+	NumItems = Items.Num();
+
+	UE_LOG(LogUnco,
+	       Display,
+	       TEXT("Processing %d items with up to %d concurrent tasks"),
+	       NumItems,
+	       MaxConcurrency);
+
+	// 同時実行数を超える分は枠が空くまで待機する
+	unco::FAsyncSemaphore Throttle(MaxConcurrency);
+	unco::FTaskScope      Scope;
+	for ( FSoftObjectPath& Item : Items )
+	{
+		co_await Throttle.Acquire();
+		Scope.Spawn(RunItem(MoveTemp(Item), unco::FAsyncSemaphoreGuard(Throttle)));
+	}
+	co_await Scope.WaitAll();
+}
+
+void UUncoRunCoroutineCommandlet::GatherItems(const FString& Params, TArray<FSoftObjectPath>& OutItems)
+{
+	TArray<FString> Paths;
+
+	FString Assets;
+	if ( FParse::Value(*Params, TEXT("Assets="), Assets, false) )
+	{
+		Assets.ParseIntoArray(Paths, TEXT(","));
+	}
+
+	FString AssetList;
+	if ( FParse::Value(*Params, TEXT("AssetList="), AssetList) )
+	{
+		TArray<FString> Lines;
+		if ( FFileHelper::LoadFileToStringArray(Lines, *AssetList) )
+		{
+			Paths.Append(Lines);
+		}
+		else
+		{
+			UE_LOG(LogUnco, Error, TEXT("Failed to read asset list %s"), *AssetList);
+		}
+	}
+
+	OutItems.Reserve(OutItems.Num() + Paths.Num());
+	for ( FString& Path : Paths )
+	{
+		Path.TrimStartAndEndInline();
+		if ( !Path.IsEmpty() )
+		{
+			OutItems.Emplace(Path);
+		}
+	}
+}
+
+unco::FObjectTask UUncoRunCoroutineCommandlet::ProcessItem(FSoftObjectPath Item)
+{
+	UObject* Asset = co_await unco::AsyncLoadAsset(this, TSoftObjectPtr<UObject>(Item));
+	if ( Asset == nullptr )
+	{
+		UE_LOG(LogUnco, Warning, TEXT("Failed to load %s"), *Item.ToString());
+		AddFailedItems();
+	}
+}
+
+unco::FObjectTask UUncoRunCoroutineCommandlet::RunRoot(FString Params)
+{
+	unco::FTaskScope Scope;
+	Scope.Spawn(RunCoroutine(MoveTemp(Params)));
+	co_await Scope.WaitAll();
+
+	bFinished = true;
+}
+
+unco::FObjectTask UUncoRunCoroutineCommandlet::RunItem(FSoftObjectPath Item, unco::FAsyncSemaphoreGuard Permit)
+{
+	unco::FTaskScope ItemScope;
+	ItemScope.Spawn(ProcessItem(MoveTemp(Item)));
+	co_await ItemScope.WaitAll();
+
+	AddProcessedItems();
+
+	// フレームの破棄を待たずに次のアイテムの処理を開始させる
+	Permit.Release();
+}
+
+void UUncoRunCoroutineCommandlet::TickFrame(float DeltaTime)
+{
+	// ワーカースレッドからゲームスレッドに投げられたタスクを実行する
+	FTaskGraphInterface::Get().ProcessThreadUntilIdle(ENamedThreads::GameThread);
+
+	// 非同期ロードを進める
+	ProcessAsyncLoading(true, false, 0.005f);
+
+	// エンジンのスケジューラーはコアティッカーで更新される
+	FTSTicker::GetCoreTicker().Tick(DeltaTime);
+
+	// フレーム番号で判定するAwaiterの為に進める
+	++GFrameCounter;
+}
+
+void UUncoRunCoroutineCommandlet::ReportProgress(double ElapsedSeconds) const
+{
+	const double ItemsPerSecond = ElapsedSeconds > 0.0 ? NumProcessed / ElapsedSeconds : 0.0;
+	UE_LOG(LogUnco,
+	       Display,
+	       TEXT("Processed %d/%d items (%d failed) in %.1f s, %.1f items/s, %.1f MB used"),
+	       NumProcessed,
+	       NumItems,
+	       NumFailed,
+	       ElapsedSeconds,
+	       ItemsPerSecond,
+	       FPlatformMemory::GetStats().UsedPhysical / (1024.0 * 1024.0));
+}
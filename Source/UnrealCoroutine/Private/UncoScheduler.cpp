@@ -2,6 +2,10 @@
 
 #include "UncoScheduler.h"
 
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "UncoMemory.h"
+#include "UncoTrace.h"
 #include "UnrealCoroutine.h"
 #include "UnrealEngine.h"
 
@@ -11,184 +15,563 @@ DECLARE_CYCLE_STAT(TEXT("Unco_DistributedFramePhase"),
 DECLARE_CYCLE_STAT(TEXT("Unco_DistributedFrame"),
                    STAT_DistributedFrame,
                    STATGROUP_Unco);
+DECLARE_CYCLE_STAT(TEXT("Unco_ResumeReady"),
+                   STAT_ResumeReady,
+                   STATGROUP_Unco);
+DECLARE_CYCLE_STAT(TEXT("Unco_TickWaiters"),
+                   STAT_TickWaiters,
+                   STATGROUP_Unco);
+DECLARE_CYCLE_STAT(TEXT("Unco_TaskTeardown"),
+                   STAT_TaskTeardown,
+                   STATGROUP_Unco);
+DECLARE_CYCLE_STAT(TEXT("Unco_WaitUntil"),
+                   STAT_WaitUntil,
+                   STATGROUP_Unco);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Unco_WaitUntilEvaluated"),
+                           STAT_WaitUntilEvaluated,
+                           STATGROUP_Unco);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Unco_WaitUntilPending"),
+                               STAT_WaitUntilPending,
+                               STATGROUP_Unco);
+DECLARE_CYCLE_STAT(TEXT("Unco_Tweens"),
+                   STAT_Tweens,
+                   STATGROUP_Unco);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Unco_ActiveTweens"),
+                               STAT_ActiveTweens,
+                               STATGROUP_Unco);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Unco_DeferredResumes"),
+                           STAT_DeferredResumes,
+                           STATGROUP_Unco);
 
 namespace unco
 {
-	FCacheObjectTask::~FCacheObjectTask()
+	namespace details
 	{
-		if ( CoroutineHandle )
+		FTaskRegistry* FindTaskRegistry(const UObject* Host)
 		{
-			CoroutineHandle.destroy();
+			UUncoScheduler* Scheduler = UUncoScheduler::Get(Host);
+			return IsValid(Scheduler) ? &Scheduler->TaskRegistry : nullptr;
 		}
-		CoroutineHandle = nullptr;
-	}
 
-	bool FCacheObjectTask::IsValid() const
-	{
-		if ( CoroutineHandle )
+		bool FTickWaitNode::SuspendOnTick(const UObject*          WorldContext,
+		                                  std::coroutine_handle<> coroutine,
+		                                  FOnTick                 InOnTick)
 		{
+			UUncoScheduler* Scheduler = UUncoScheduler::Get(WorldContext);
+			if ( !IsValid(Scheduler) )
+			{
+				return false;
+			}
+
+			Coroutine     = coroutine;
+			OnTick        = InOnTick;
+			ContextObject = WorldContext;
+			Scheduler->AddTickWaiter(*this);
 			return true;
 		}
-		return false;
-	}
 
-} // namespace unco
+		FWaitUntilNode::~FWaitUntilNode()
+		{
+			if ( EntryIndex != INDEX_NONE )
+			{
+				if ( UUncoScheduler* OwnerScheduler = Scheduler.Get() )
+				{
+					OwnerScheduler->RemoveWaitUntil(*this);
+				}
+			}
+		}
+
+		bool FWaitUntilNode::SuspendUntil(const UObject*          WorldContext,
+		                                  std::coroutine_handle<> coroutine,
+		                                  FEvaluate               InEvaluate,
+		                                  int32                   Cadence)
+		{
+			UUncoScheduler* OwnerScheduler = UUncoScheduler::Get(WorldContext);
+			if ( !IsValid(OwnerScheduler) )
+			{
+				return false;
+			}
+
+			Coroutine     = coroutine;
+			Evaluate      = InEvaluate;
+			ContextObject = WorldContext;
+			OwnerScheduler->AddWaitUntil(*this, Cadence);
+			return true;
+		}
+	} // namespace details
 
-// Begin USubsystem
+} // namespace unco
 
-// サブシステムの初期化
-void UUncoScheduler::Initialize(FSubsystemCollectionBase& Collection)
+void UUncoScheduler::Initialize()
 {
-	Super::Initialize(Collection);
+	PostGarbageCollectHandle = FCoreUObjectDelegates::GetPostGarbageCollect().AddUObject(
+	    this, &UUncoScheduler::OnPostGarbageCollect);
 }
 
-// サブシステムの終了
 void UUncoScheduler::Deinitialize()
 {
-	Super::Deinitialize();
+	FCoreUObjectDelegates::GetPostGarbageCollect().Remove(PostGarbageCollectHandle);
 
-	Tasks.Empty();
-}
+	// 所有しているタスクを先に破棄する
+	// 待機中のAwaiterはデストラクタで登録を解除する
+	TaskRegistry.Reset();
+	DistributedFrames.Empty();
 
-// End USubsystem
+	// 残っている待機は他のスケジューラーやFTaskScopeが所有するタスクのもので、
+	// 登録を解除すると二度と再開されない
+	const int32 NumForeignWaits = ReadyList.Num() + TickWaiters.Num() + WaitUntilEntries.Num() + Tweens.Num();
+	if ( NumForeignWaits > 0 )
+	{
+		UE_LOG(LogUnco,
+		       Warning,
+		       TEXT("%s: %d waits of coroutines not owned by this scheduler will never resume. "
+		            "Wait on a context that outlives this scheduler (e.g. the engine scheduler)."),
+		       *GetPathName(),
+		       NumForeignWaits);
+	}
 
-// Begin UTickableWorldSubsystem
+	ReadyList.Reset();
+	TickWaiters.Reset();
+	for ( const unco::details::FWaitUntilEntry& Entry : WaitUntilEntries )
+	{
+		Entry.Node->EntryIndex = INDEX_NONE;
+	}
+	WaitUntilEntries.Empty();
+	Tweens.Reset();
+}
 
 void UUncoScheduler::Tick(float DeltaTime)
 {
-	// フレーム分散が存在している場合実行
-	if ( DistributedFrameLists.Num() > 0 )
+	TimeSeconds += DeltaTime;
+
+	// 終了したタスクをまとめて破棄する
+	if ( TaskRegistry.HasFinishedTasks() || bSweepInvalidHosts )
 	{
-		SCOPE_CYCLE_COUNTER(STAT_DistributedFramePhase);
+		CollectFinishedTasks();
+	}
+
+	// イベントで再開が予約されたコルーチンを再開
+	if ( !ReadyList.IsEmpty() )
+	{
+		SCOPE_CYCLE_COUNTER(STAT_ResumeReady);
+		UNCO_TRACE_WAKE_SCOPE(Ready);
+		unco::details::ResumeAll(ReadyList);
+	}
 
-		bIsDistributedFrame = true;
+	// Tick毎に更新される待機ノードを更新
+	if ( !TickWaiters.IsEmpty() )
+	{
+		SCOPE_CYCLE_COUNTER(STAT_TickWaiters);
+		UNCO_TRACE_WAKE_SCOPE(Tick);
 
-		float ElapsedTimeArray[100] = {};
-		int32 index                 = 0;
+		// 更新中の追加・破棄に備えて退避させる
+		// 更新中に追加されたものは次のTickから更新される
+		unco::details::TWaitList<unco::details::FTickWaitNode> Pending;
+		Pending.Append(TickWaiters);
 
-		//
-		for ( unco::FDistributedFrameInfo& FrameInfo : DistributedFrameLists )
+		NumTickResumes = 0;
+		while ( unco::details::FTickWaitNode* Node = Pending.PopFront() )
 		{
-			SCOPE_CYCLE_COUNTER(STAT_DistributedFrame);
-
-			unco::FObjectGenerator& Generator   = FrameInfo.Generator;
-			const float             FrameTime   = FrameInfo.FrameTime;
-			const FDateTime         StartTime   = FDateTime::Now();
-			float                   ElapsedTime = 0.0f;
+			// ワールドコンテキストが破棄された待機は判定も再開もせずに登録を解除する
+			// コルーチンはホストの破棄と共に破棄される
+			if ( !Node->ContextObject.IsValid() )
+			{
+				continue;
+			}
 
-			do
+			if ( !Node->bDue )
 			{
-				// コルーチンの内部処理を実行
-				Generator.MoveNext();
+				if ( !ShouldTickWaiter(*Node, DeltaTime) )
+				{
+					TickWaiters.PushBack(*Node);
+					continue;
+				}
+
+				// 飛ばしたフレームの経過時間をまとめて渡す
+				const float NodeDeltaTime = DeltaTime + std::exchange(Node->SkippedTime, 0.f);
+				if ( !Node->OnTick(*Node, NodeDeltaTime) )
+				{
+					TickWaiters.PushBack(*Node);
+					continue;
+				}
+				Node->bDue = true;
+			}
+
+			// 再開が混み合っている場合は許容時間内で次のフレームに回す
+			if ( ShouldDeferResume(*Node, DeltaTime) )
+			{
+				INC_DWORD_STAT(STAT_DeferredResumes);
+				TickWaiters.PushBack(*Node);
+				continue;
+			}
+
+			// コルーチンを再開
+			++NumTickResumes;
+			Node->bDue = false;
+			Node->Coroutine.resume();
+		}
+	}
 
-				// 経過時間を保存
-				ElapsedTime = static_cast<float>(
-				    (FDateTime::Now() - StartTime).GetTotalMilliseconds());
+	// 条件待機をまとめて判定
+	if ( WaitUntilEntries.Num() > 0 )
+	{
+		EvaluateWaitUntil();
+	}
 
-				// コルーチンが終わっている or 経過時間が指定時間を超えるかチェックする
-			} while ( !Generator.Done() && ElapsedTime < FrameTime );
-		}
+	// トゥイーンをまとめて進めて終わったものを再開
+	if ( Tweens.Num() > 0 )
+	{
+		SCOPE_CYCLE_COUNTER(STAT_Tweens);
+		UNCO_TRACE_WAKE_SCOPE(Tick);
+
+		unco::details::TWaitList<unco::details::FCoroutineWaitNode> Finished;
+		Tweens.Advance(DeltaTime, Finished);
+		SET_DWORD_STAT(STAT_ActiveTweens, Tweens.Num());
+		unco::details::ResumeAll(Finished);
+	}
 
-		// 分散フレームが終了したものを削除
-		DistributedFrameLists.RemoveAll(
-		    [&](const unco::FDistributedFrameInfo& Cache)
+	// フレーム分散が存在している場合実行
+	if ( DistributedFrames.Num() > 0 )
+	{
+		SCOPE_CYCLE_COUNTER(STAT_DistributedFramePhase);
+		UNCO_TRACE_WAKE_SCOPE(DistributedFrame);
+
+		DistributedFrames.Run(
+		    [this](unco::FDistributedFrameInfo& FrameInfo)
 		    {
-			    // コルーチンが終了した物
-			    if ( Cache.Generator.Done() )
-			    {
-				    return true;
-			    }
-			    // 呼び出し元のオブジェクトが破棄されたか？
-			    if ( !Cache.Generator.IsValidObject() )
+			    SCOPE_CYCLE_COUNTER(STAT_DistributedFrame);
+			    UNCO_TRACE_CPU_SCOPE(FrameInfo.Generator.GetHostObject());
+
+			    // 重要度が低いホストは処理量を減らし、0以下の場合は実行しない
+			    const float Significance = GetSignificance(FrameInfo.Generator.GetHostObject());
+			    if ( Significance <= 0.f )
 			    {
-				    return true;
+				    return;
 			    }
-
-			    return false;
+			    unco::details::StepDistributedFrame(
+			        FrameInfo,
+			        Significance < 1.f ? FrameInfo.Budget.Scale(Significance) : FrameInfo.Budget);
 		    });
+	}
+}
 
-		// コルーチン実行中に追加された物はループ後に追加する
-		for ( unco::FDistributedFrameInfo& Info : DelayDistributedFrameLists )
-		{
-			DistributedFrameLists.Emplace(std::move(Info));
-		}
+UUncoScheduler* UUncoScheduler::Get(const UObject* InWorldContext)
+{
+	if ( InWorldContext == nullptr )
+	{
+		return nullptr;
+	}
 
-		DelayDistributedFrameLists.Empty();
+	// スケジューラー自体が渡された
+	if ( const UUncoScheduler* Scheduler = Cast<UUncoScheduler>(InWorldContext) )
+	{
+		return const_cast<UUncoScheduler*>(Scheduler);
+	}
 
-		// フラグを無効化する
-		bIsDistributedFrame = false;
+	const UWorld* World = GEngine->GetWorldFromContextObject(
+	    InWorldContext, EGetWorldErrorMode::ReturnNull);
+	if ( IsValid(World) )
+	{
+		if ( const UUncoWorldScheduler* WorldScheduler = World->GetSubsystem<UUncoWorldScheduler>() )
+		{
+			return WorldScheduler->GetScheduler();
+		}
 	}
+
+	// ワールドに属さないオブジェクトはエンジンのスケジューラーで実行する
+	return GetEngineScheduler();
 }
 
-TStatId UUncoScheduler::GetStatId() const
+UUncoScheduler* UUncoScheduler::GetEngineScheduler()
 {
-	RETURN_QUICK_DECLARE_CYCLE_STAT(UUncoScheduler, STATGROUP_Tickables);
+	if ( GEngine == nullptr )
+	{
+		return nullptr;
+	}
+	const UUncoEngineScheduler* EngineScheduler = GEngine->GetEngineSubsystem<UUncoEngineScheduler>();
+	return EngineScheduler != nullptr ? EngineScheduler->GetScheduler() : nullptr;
 }
 
-// End UTickableWorldSubsystem
-
-UUncoScheduler* UUncoScheduler::Get(const UObject* InWorldContext)
+void UUncoScheduler::Adopt(unco::FObjectTask&& Task)
 {
-	const UWorld* World = GEngine->GetWorldFromContextObject(
-	    InWorldContext, EGetWorldErrorMode::ReturnNull);
-	if ( IsValid(World) )
+	std::coroutine_handle<unco::FObjectTaskPromise> Handle =
+	    std::exchange(Task.CoroutineHandle, nullptr);
+	const FWeakObjectPtr HostObject = std::exchange(Task.HostObject, nullptr);
+	if ( !Handle )
+	{
+		return;
+	}
+
+	if ( Handle.promise().bFinalized )
 	{
-		return Cast<UUncoScheduler>(
-		    World->GetSubsystemBase(UUncoScheduler::StaticClass()));
+		// 最初のサスペンドまでに終了している
+		Handle.destroy();
+		return;
 	}
-	return nullptr;
+
+	TaskRegistry.Register(HostObject, Handle);
 }
 
 /**
 	 * @brief 分散フレーム実行をリクエストする
 	 * @param InWorldContext ワールドコンテキスト
-	 * @param InFrameTime 1フレームに実行する時間(sec)
+	 * @param InFrameTime 1フレームに実行する時間(ms)
 	 * @param Generator 実行するコルーチン
 	*/
 void UUncoScheduler::DistributedFrame(const UObject*           InWorldContext,
                                       float                    InFrameTime,
                                       unco::FObjectGenerator&& Generator)
+{
+	// 時間が0以下の場合は従来通り1フレームに1ステップずつ実行する
+	DistributedFrame(InWorldContext,
+	                 InFrameTime > 0.f ? unco::FFrameBudget::Time(InFrameTime) : unco::FFrameBudget::Items(1),
+	                 std::move(Generator));
+}
+
+void UUncoScheduler::DistributedFrame(const UObject*            InWorldContext,
+                                      const unco::FFrameBudget& Budget,
+                                      unco::FObjectGenerator&&  Generator,
+                                      bool                      bCarryOver)
 {
 	UUncoScheduler* Scheduler = Get(InWorldContext);
-	if ( IsValid(InWorldContext) )
+	if ( IsValid(Scheduler) )
 	{
-		if ( Scheduler->bIsDistributedFrame )
+		// 無制限の場合は終わらないジェネレーターが1フレームを占有しない様に1フレームに1ステップずつ実行する
+		Scheduler->DistributedFrames.Add(std::move(Generator),
+		                                 Budget.IsUnlimited() ? unco::FFrameBudget::Items(1) : Budget,
+		                                 bCarryOver);
+	}
+}
+
+void UUncoScheduler::AddTickWaiter(unco::details::FTickWaitNode& Node)
+{
+	TickWaiters.PushBack(Node);
+}
+
+void UUncoScheduler::ScheduleResume(unco::details::FCoroutineWaitNode& Node)
+{
+	ReadyList.PushBack(Node);
+}
+
+void UUncoScheduler::SetSignificanceProvider(unco::FSignificanceProvider InProvider,
+                                             int32                       InMaxTickInterval)
+{
+	SignificanceProvider = MoveTemp(InProvider);
+	MaxTickInterval      = FMath::Max(InMaxTickInterval, 1);
+}
+
+void UUncoScheduler::AddWaitUntil(unco::details::FWaitUntilNode& Node, int32 Cadence)
+{
+	check(Node.EntryIndex == INDEX_NONE);
+
+	UNCO_LLM_SCOPE();
+
+	Cadence = FMath::Max(Cadence, 1);
+
+	Node.Scheduler  = this;
+	Node.EntryIndex = WaitUntilEntries.Add({&Node, Cadence, Cadence});
+}
+
+void UUncoScheduler::RemoveWaitUntil(unco::details::FWaitUntilNode& Node)
+{
+	const int32 Index = Node.EntryIndex;
+	check(WaitUntilEntries.IsValidIndex(Index) && WaitUntilEntries[Index].Node == &Node);
+
+	WaitUntilEntries.RemoveAtSwap(Index, 1, false);
+	if ( WaitUntilEntries.IsValidIndex(Index) )
+	{
+		WaitUntilEntries[Index].Node->EntryIndex = Index;
+	}
+	Node.EntryIndex = INDEX_NONE;
+}
+
+void UUncoScheduler::EvaluateWaitUntil()
+{
+	SCOPE_CYCLE_COUNTER(STAT_WaitUntil);
+	UNCO_TRACE_WAKE_SCOPE(Tick);
+
+	// 条件を満たしたものは配列から取り除いて詰める
+	// 再開は走査の後にまとめて行うので、再開中に配列が変更されても問題無い
+	unco::details::TWaitList<unco::details::FCoroutineWaitNode> Ready;
+	int32 NumEvaluated = 0;
+	int32 WriteIndex   = 0;
+	for ( int32 ReadIndex = 0; ReadIndex < WaitUntilEntries.Num(); ++ReadIndex )
+	{
+		unco::details::FWaitUntilEntry Entry = WaitUntilEntries[ReadIndex];
+
+		// ワールドコンテキストが破棄された待機は判定も再開もせずに取り除く
+		if ( !Entry.Node->ContextObject.IsValid() )
+		{
+			Entry.Node->EntryIndex = INDEX_NONE;
+			continue;
+		}
+
+		bool bReady = false;
+		if ( --Entry.Countdown <= 0 )
+		{
+			Entry.Countdown = Entry.Cadence;
+			++NumEvaluated;
+			bReady = Entry.Node->Evaluate(*Entry.Node);
+		}
+
+		if ( bReady )
 		{
-			// 実行中に追加はさせたくないので遅延で追加させる
-			Scheduler->DelayDistributedFrameLists.Emplace(std::move(Generator),
-			                                              InFrameTime);
+			Entry.Node->EntryIndex = INDEX_NONE;
+			Ready.PushBack(*Entry.Node);
 		}
 		else
 		{
-			Scheduler->DistributedFrameLists.Emplace(std::move(Generator),
-			                                         InFrameTime);
+			Entry.Node->EntryIndex        = WriteIndex;
+			WaitUntilEntries[WriteIndex++] = Entry;
 		}
 	}
+	WaitUntilEntries.SetNum(WriteIndex, false);
+
+	INC_DWORD_STAT_BY(STAT_WaitUntilEvaluated, NumEvaluated);
+	SET_DWORD_STAT(STAT_WaitUntilPending, WaitUntilEntries.Num());
+
+	unco::details::ResumeAll(Ready);
 }
 
-void UUncoScheduler::RegisterTask(
-    FWeakObjectPtr                                  InObject,
-    std::coroutine_handle<unco::FObjectTaskPromise> InPromise)
+void UUncoScheduler::AddTween(unco::details::FTweenNode& Node, float Duration, unco::ETweenEasing Easing)
 {
-	// 念の為事前に終わっているものを削除しておく
-	Tasks.RemoveAll(
-	    [](const unco::FCacheObjectTask& Cache)
-	    {
-		    return !Cache.IsValid();
-	    });
+	UNCO_LLM_SCOPE();
+	Tweens.Add(Node, this, Duration, Easing);
+}
+
+void UUncoScheduler::RemoveTween(unco::details::FTweenNode& Node)
+{
+	Tweens.Remove(Node);
+}
+
+void UUncoScheduler::SetResumeQuota(int32 InMaxResumesPerFrame)
+{
+	ResumeQuota = InMaxResumesPerFrame;
+}
+
+void UUncoScheduler::CollectFinishedTasks()
+{
+	SCOPE_CYCLE_COUNTER(STAT_TaskTeardown);
+
+	const bool bSweepHosts = bSweepInvalidHosts;
+	bSweepInvalidHosts     = false;
+
+	TaskRegistry.Collect(bSweepHosts);
+}
 
-	Tasks.Emplace(InPromise, InObject);
+void UUncoScheduler::OnPostGarbageCollect()
+{
+	// GC直後はコルーチンを破棄しても安全なタイミングとは限らないので次のTickで行う
+	bSweepInvalidHosts = TaskRegistry.Num() > 0;
+}
+
+float UUncoScheduler::GetSignificance(const UObject* Host) const
+{
+	// ホストが無い・破棄されたものは調整しない
+	if ( !SignificanceProvider || Host == nullptr )
+	{
+		return 1.f;
+	}
+	return SignificanceProvider(Host);
 }
 
-void UUncoScheduler::UnregisterTask(
-    FWeakObjectPtr                                  InObject,
-    std::coroutine_handle<unco::FObjectTaskPromise> InPromise)
+bool UUncoScheduler::ShouldTickWaiter(unco::details::FTickWaitNode& Node, float DeltaTime) const
 {
-	// 念の為事前に終わっているものを削除しておく
-	Tasks.RemoveAll(
-	    [&](const unco::FCacheObjectTask& Cache)
-	    {
-		    return Cache.HostObject == InObject &&
-		           Cache.CoroutineHandle == InPromise;
-	    });
-}
\ No newline at end of file
+	if ( !SignificanceProvider )
+	{
+		return true;
+	}
+
+	const float Significance = GetSignificance(Node.ContextObject.Get());
+	if ( Significance >= 1.f )
+	{
+		Node.SkippedFrames = 0;
+		return true;
+	}
+
+	// 重要度の逆数のフレーム毎に更新する
+	const int32 Interval =
+	    Significance > 0.f ? FMath::Clamp(FMath::FloorToInt(1.f / Significance), 1, MaxTickInterval) : MAX_int32;
+	if ( ++Node.SkippedFrames < Interval )
+	{
+		Node.SkippedTime += DeltaTime;
+		return false;
+	}
+
+	Node.SkippedFrames = 0;
+	return true;
+}
+
+bool UUncoScheduler::ShouldDeferResume(unco::details::FTickWaitNode& Node, float DeltaTime) const
+{
+	if ( ResumeQuota <= 0 || Node.LatenessTolerance <= 0.f || NumTickResumes < ResumeQuota )
+	{
+		return false;
+	}
+
+	// 次のフレームまで遅らせると許容時間を超える場合は再開する
+	if ( Node.Lateness + DeltaTime > Node.LatenessTolerance )
+	{
+		return false;
+	}
+
+	Node.Lateness += DeltaTime;
+	return true;
+}
+
+////////////////////////////////////////////////////////
+// UUncoWorldScheduler
+
+void UUncoWorldScheduler::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	Scheduler = NewObject<UUncoScheduler>(this);
+	Scheduler->Initialize();
+}
+
+void UUncoWorldScheduler::Deinitialize()
+{
+	Super::Deinitialize();
+
+	// ワールドと共にタスクを破棄する
+	Scheduler->Deinitialize();
+}
+
+void UUncoWorldScheduler::Tick(float DeltaTime)
+{
+	Scheduler->Tick(DeltaTime);
+}
+
+TStatId UUncoWorldScheduler::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UUncoWorldScheduler, STATGROUP_Tickables);
+}
+
+////////////////////////////////////////////////////////
+// UUncoEngineScheduler
+
+void UUncoEngineScheduler::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	Scheduler = NewObject<UUncoScheduler>(this);
+	Scheduler->Initialize();
+
+	TickHandle = FTSTicker::GetCoreTicker().AddTicker(
+	    FTickerDelegate::CreateUObject(this, &UUncoEngineScheduler::Tick));
+}
+
+void UUncoEngineScheduler::Deinitialize()
+{
+	Super::Deinitialize();
+
+	FTSTicker::GetCoreTicker().RemoveTicker(TickHandle);
+	Scheduler->Deinitialize();
+}
+
+bool UUncoEngineScheduler::Tick(float DeltaTime)
+{
+	Scheduler->Tick(DeltaTime);
+	return true;
+}
@@ -0,0 +1,71 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "UncoSliced.h"
+
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "UnrealCoroutine.h"
+
+DECLARE_CYCLE_STAT(TEXT("Unco_Sliced"), STAT_Sliced, STATGROUP_Unco);
+
+namespace unco::details
+{
+
+	////////////////////////////////////////////////////////
+	// FSlicedAwaiterBase
+
+	FSlicedAwaiterBase::FSlicedAwaiterBase(const UObject*      InWorldContext,
+	                                       const FFrameBudget& InBudget,
+	                                       FRunSlice           InRunSlice)
+	    : WorldContext(InWorldContext)
+	    , Budget(InBudget)
+	    , RunSlice(InRunSlice)
+	{
+	}
+
+	bool FSlicedAwaiterBase::await_suspend(std::coroutine_handle<> coroutine)
+	{
+		if ( SuspendOnTick(WorldContext.Get(), coroutine, &FSlicedAwaiterBase::OnTickSliced) )
+		{
+			return true;
+		}
+
+		// 分けて実行出来ないのでこの場で全て処理する
+		FFrameBudgetTimer Timer(FFrameBudget{});
+		RunSlice(*this, Timer);
+		return false;
+	}
+
+	bool FSlicedAwaiterBase::OnTickSliced(FTickWaitNode& Node, float DeltaTime)
+	{
+		FSlicedAwaiterBase& Self = static_cast<FSlicedAwaiterBase&>(Node);
+		SCOPE_CYCLE_COUNTER(STAT_Sliced);
+		FFrameBudgetTimer Timer(Self.Budget, ClockInterval);
+		return Self.RunSlice(Self, Timer);
+	}
+
+	////////////////////////////////////////////////////////
+	// FSlicedForEachActorAwaiterBase
+
+	FSlicedForEachActorAwaiterBase::FSlicedForEachActorAwaiterBase(const UObject*      InWorldContext,
+	                                                               TSubclassOf<AActor> InClass,
+	                                                               const FFrameBudget& InBudget,
+	                                                               FRunSlice           InRunSlice)
+	    : FSlicedAwaiterBase(InWorldContext, InBudget, InRunSlice)
+	{
+		const UWorld* World = GEngine->GetWorldFromContextObject(
+		    InWorldContext, EGetWorldErrorMode::LogAndReturnNull);
+		if ( World == nullptr )
+		{
+			return;
+		}
+
+		// イテレーターはフレームを跨いで保持出来ないので弱参照で列挙しておく
+		for ( TActorIterator<AActor> It(World, InClass); It; ++It )
+		{
+			Actors.Add(*It);
+		}
+	}
+
+} // namespace unco::details
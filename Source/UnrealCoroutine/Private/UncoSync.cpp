@@ -0,0 +1,98 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "UncoSync.h"
+
+namespace unco
+{
+
+	namespace details
+	{
+		bool FSemaphoreAwaiter::await_ready()
+		{
+			return Semaphore.TryAcquire();
+		}
+
+		void FSemaphoreAwaiter::await_suspend(std::coroutine_handle<> coroutine)
+		{
+			Coroutine = coroutine;
+			Semaphore.Waiters.PushBack(*this);
+		}
+
+		bool FEventAwaiter::await_ready() const noexcept
+		{
+			return Event.bSet;
+		}
+
+		void FEventAwaiter::await_suspend(std::coroutine_handle<> coroutine)
+		{
+			Coroutine = coroutine;
+			Event.Waiters.PushBack(*this);
+		}
+	} // namespace details
+
+	////////////////////////////////////////////////////////
+	// FAsyncSemaphoreGuard
+
+	void FAsyncSemaphoreGuard::Release()
+	{
+		if ( FAsyncSemaphore* Owner = std::exchange(Semaphore, nullptr) )
+		{
+			Owner->Release();
+		}
+	}
+
+	////////////////////////////////////////////////////////
+	// FAsyncSemaphore
+
+	FAsyncSemaphore::~FAsyncSemaphore()
+	{
+		// セマフォが破棄されるので待機者は切り離す
+		Waiters.Reset();
+	}
+
+	bool FAsyncSemaphore::TryAcquire()
+	{
+		check(IsInGameThread());
+
+		// 待機者がいる場合は追い越さない
+		if ( Count > 0 && Waiters.IsEmpty() )
+		{
+			--Count;
+			return true;
+		}
+		return false;
+	}
+
+	void FAsyncSemaphore::Release()
+	{
+		check(IsInGameThread());
+
+		// カウントを戻さずに先頭の待機者へ直接渡す
+		if ( details::FCoroutineWaitNode* Waiter = Waiters.PopFront() )
+		{
+			Waiter->Coroutine.resume();
+			return;
+		}
+		++Count;
+	}
+
+	////////////////////////////////////////////////////////
+	// FAsyncEvent
+
+	FAsyncEvent::~FAsyncEvent()
+	{
+		// イベントが破棄されるので待機者は切り離す
+		Waiters.Reset();
+	}
+
+	void FAsyncEvent::Set()
+	{
+		check(IsInGameThread());
+
+		bSet = true;
+
+		// 再開先でイベントが破棄される可能性がある為最後にまとめて行う
+		details::ResumeAll(Waiters);
+	}
+
+} // namespace unco
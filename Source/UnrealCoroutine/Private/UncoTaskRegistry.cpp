@@ -0,0 +1,94 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "UncoTaskRegistry.h"
+
+#include "UncoMemory.h"
+#include <utility>
+
+namespace unco
+{
+	FCacheObjectTask::~FCacheObjectTask()
+	{
+		if ( CoroutineHandle )
+		{
+			CoroutineHandle.destroy();
+		}
+		CoroutineHandle = nullptr;
+	}
+
+	bool FCacheObjectTask::IsValid() const
+	{
+		if ( CoroutineHandle )
+		{
+			return true;
+		}
+		return false;
+	}
+
+	bool FCacheObjectTask::IsFinalized() const
+	{
+		return CoroutineHandle && CoroutineHandle.promise().bFinalized;
+	}
+
+	namespace details
+	{
+		FTaskRegistry::~FTaskRegistry()
+		{
+			Reset();
+		}
+
+		void FTaskRegistry::Register(FWeakObjectPtr                            HostObject,
+		                             std::coroutine_handle<FObjectTaskPromise> Handle)
+		{
+			UNCO_LLM_SCOPE();
+
+			// 終了したものの削除はCollectでまとめて行う
+			Handle.promise().Registry = this;
+			Tasks.Emplace(Handle, HostObject);
+		}
+
+		void FTaskRegistry::Collect(bool bSweepHosts)
+		{
+			NumFinished = 0;
+
+			// 破棄するタスクのハンドルを取り出してから配列を詰め、その後でまとめて破棄する
+			// 破棄中のAwaiterのデストラクタから登録されても走査中の配列を変更させない為
+			// 呼び出し元オブジェクトが破棄されたタスクも破棄する(待機中のAwaiterはデストラクタで待機を中断する)
+			TArray<std::coroutine_handle<FObjectTaskPromise>> Destroying = MoveTemp(DestroyBuffer);
+			for ( FCacheObjectTask& Cache : Tasks )
+			{
+				if ( !Cache.IsValid() )
+				{
+					continue;
+				}
+				if ( Cache.IsFinalized() || (bSweepHosts && !Cache.HostObject.IsValid()) )
+				{
+					Destroying.Add(std::exchange(Cache.CoroutineHandle, nullptr));
+				}
+			}
+			Tasks.RemoveAllSwap(
+			    [](const FCacheObjectTask& Cache)
+			    {
+				    return !Cache.IsValid();
+			    });
+
+			for ( std::coroutine_handle<FObjectTaskPromise> Handle : Destroying )
+			{
+				Handle.destroy();
+			}
+
+			// 確保した領域は次のCollectで再利用する
+			Destroying.Reset();
+			DestroyBuffer = MoveTemp(Destroying);
+		}
+
+		void FTaskRegistry::Reset()
+		{
+			// 破棄中のタスクから再度登録されても良い様に退避させる
+			TArray<FCacheObjectTask> Destroying = MoveTemp(Tasks);
+			NumFinished                         = 0;
+		}
+
+	} // namespace details
+
+} // namespace unco
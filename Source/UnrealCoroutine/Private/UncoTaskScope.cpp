@@ -0,0 +1,135 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "UncoTaskScope.h"
+
+#include "UncoMemory.h"
+#include "UnrealCoroutine.h"
+
+DECLARE_CYCLE_STAT(TEXT("Unco_TaskScopeTeardown"),
+                   STAT_TaskScopeTeardown,
+                   STATGROUP_Unco);
+
+namespace unco
+{
+
+	namespace details
+	{
+		bool FTaskScopeAwaiter::await_ready() const noexcept
+		{
+			return Scope.NumRunning == 0;
+		}
+
+		void FTaskScopeAwaiter::await_suspend(std::coroutine_handle<> coroutine)
+		{
+			Coroutine = coroutine;
+			Scope.Joiners.PushBack(*this);
+		}
+
+		void FTaskScopeAwaiter::await_resume()
+		{
+			// 終了した子タスクのフレームをまとめて破棄する
+			Scope.CollectFinished();
+		}
+	} // namespace details
+
+	FTaskScope::~FTaskScope()
+	{
+		Cancel();
+
+		// スコープが破棄されるので待機者は切り離す
+		Joiners.Reset();
+	}
+
+	void FTaskScope::Spawn(FObjectTask&& Task)
+	{
+		std::coroutine_handle<FObjectTaskPromise> Handle =
+		    std::exchange(Task.CoroutineHandle, nullptr);
+		Task.HostObject = nullptr;
+		if ( !Handle )
+		{
+			return;
+		}
+
+		if ( Handle.promise().bFinalized )
+		{
+			// 最初のサスペンドまでに終了している
+			Handle.destroy();
+			return;
+		}
+
+		// 終了したものが溜まっていたら追加前にまとめて破棄しておく
+		if ( NumFinished > 0 && NumFinished >= NumRunning )
+		{
+			CollectFinished();
+		}
+
+		UNCO_LLM_SCOPE();
+		Handle.promise().Scope = this;
+		Children.Add(Handle);
+		++NumRunning;
+	}
+
+	void FTaskScope::Cancel()
+	{
+		if ( Children.Num() == 0 )
+		{
+			return;
+		}
+
+		{
+			SCOPE_CYCLE_COUNTER(STAT_TaskScopeTeardown);
+
+			// 破棄中に子タスクのデストラクタから再度Spawn/Cancelされても良い様に退避させる
+			TArray<std::coroutine_handle<FObjectTaskPromise>> Destroying =
+			    MoveTemp(Children);
+			NumRunning  = 0;
+			NumFinished = 0;
+
+			for ( std::coroutine_handle<FObjectTaskPromise> Handle : Destroying )
+			{
+				Handle.promise().Scope = nullptr;
+				Handle.destroy();
+			}
+		}
+
+		// 待機しているコルーチンを再開する
+		// 再開先でスコープが破棄される可能性がある為最後に行う
+		details::ResumeAll(Joiners);
+	}
+
+	void FTaskScope::OnChildFinished()
+	{
+		--NumRunning;
+		++NumFinished;
+
+		if ( NumRunning == 0 )
+		{
+			// 全ての子タスクが終了したので待機しているコルーチンを再開する
+			// 再開先でスコープが破棄される可能性がある為最後に行う
+			details::ResumeAll(Joiners);
+		}
+	}
+
+	void FTaskScope::CollectFinished()
+	{
+		if ( NumFinished == 0 )
+		{
+			return;
+		}
+
+		SCOPE_CYCLE_COUNTER(STAT_TaskScopeTeardown);
+
+		NumFinished = 0;
+		Children.RemoveAllSwap(
+		    [](std::coroutine_handle<FObjectTaskPromise> Handle)
+		    {
+			    if ( Handle.promise().bFinalized )
+			    {
+				    Handle.destroy();
+				    return true;
+			    }
+			    return false;
+		    });
+	}
+
+} // namespace unco
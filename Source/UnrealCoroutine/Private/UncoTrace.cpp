@@ -0,0 +1,224 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "UncoTrace.h"
+
+#if UNCO_TRACE_ENABLED
+
+	#include "HAL/PlatformTLS.h"
+	#include "HAL/PlatformTime.h"
+	#include "ProfilingDebugging/CpuProfilerTrace.h"
+	#include <atomic>
+
+UE_TRACE_CHANNEL_DEFINE(UncoChannel);
+
+UE_TRACE_EVENT_BEGIN(Unco, CoroutineCreate)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint64, CoroutineId)
+	UE_TRACE_EVENT_FIELD(uint32, ThreadId)
+	UE_TRACE_EVENT_FIELD(UE::Trace::WideString, HostObject)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(Unco, CoroutineSuspend)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint64, CoroutineId)
+	UE_TRACE_EVENT_FIELD(uint32, ThreadId)
+	UE_TRACE_EVENT_FIELD(uint32, Line)
+	UE_TRACE_EVENT_FIELD(UE::Trace::AnsiString, Awaiter)
+	UE_TRACE_EVENT_FIELD(UE::Trace::AnsiString, Function)
+	UE_TRACE_EVENT_FIELD(UE::Trace::AnsiString, File)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(Unco, CoroutineResume)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint64, CoroutineId)
+	UE_TRACE_EVENT_FIELD(uint32, ThreadId)
+	UE_TRACE_EVENT_FIELD(uint64, WakerId)
+	UE_TRACE_EVENT_FIELD(uint8, Reason)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(Unco, CoroutineFinish)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint64, CoroutineId)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(Unco, CoroutineDestroy)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint64, CoroutineId)
+UE_TRACE_EVENT_END()
+
+namespace unco::details
+{
+
+	namespace
+	{
+		std::atomic<uint64> GNextCoroutineId{1};
+
+		// 実行中のコルーチン
+		// 他のコルーチンを直接再開した場合の因果関係に使用する
+		thread_local uint64           GRunningCoroutineId = 0;
+		thread_local ETraceWakeReason GWakeReason         = ETraceWakeReason::Direct;
+
+		bool IsCpuTraceEnabled()
+		{
+			return UE_TRACE_CHANNELEXPR_IS_ENABLED(UncoChannel)
+			    && UE_TRACE_CHANNELEXPR_IS_ENABLED(CpuChannel);
+		}
+
+		// IDを割り当てる
+		// チャンネルが無効な間に生成されたコルーチンはここで生成イベントを出力する
+		uint64 AssignId(FCoroutineTraceState& State, const UObject* HostObject)
+		{
+			if ( State.Id == 0 )
+			{
+				State.Id = GNextCoroutineId.fetch_add(1, std::memory_order_relaxed);
+
+				const FString HostName = HostObject != nullptr ? HostObject->GetPathName() : FString();
+				UE_TRACE_LOG(Unco, CoroutineCreate, UncoChannel)
+				    << CoroutineCreate.Cycle(FPlatformTime::Cycles64())
+				    << CoroutineCreate.CoroutineId(State.Id)
+				    << CoroutineCreate.ThreadId(FPlatformTLS::GetCurrentThreadId())
+				    << CoroutineCreate.HostObject(*HostName, HostName.Len());
+			}
+			return State.Id;
+		}
+
+		void EndSpan(FCoroutineTraceState& State)
+		{
+			if ( State.bSpanOpen )
+			{
+				State.bSpanOpen = false;
+				FCpuProfilerTrace::OutputEndEvent();
+			}
+		}
+	} // namespace
+
+	void TraceCreate(FCoroutineTraceState& State, const UObject* HostObject)
+	{
+		if ( !IsTraceEnabled() )
+		{
+			return;
+		}
+
+		// initial_suspendでサスペンドしないので生成元の上でそのまま実行される
+		State.ResumerId     = GRunningCoroutineId;
+		GRunningCoroutineId = AssignId(State, HostObject);
+	}
+
+	void TraceSuspend(FCoroutineTraceState&       State,
+	                  std::string_view            AwaiterType,
+	                  const std::source_location& Location)
+	{
+		const uint64 Id = AssignId(State, nullptr);
+
+		State.FunctionName = Location.function_name();
+		EndSpan(State);
+
+		const std::string_view Function = Location.function_name();
+		const std::string_view File     = Location.file_name();
+		UE_TRACE_LOG(Unco, CoroutineSuspend, UncoChannel)
+		    << CoroutineSuspend.Cycle(FPlatformTime::Cycles64())
+		    << CoroutineSuspend.CoroutineId(Id)
+		    << CoroutineSuspend.ThreadId(FPlatformTLS::GetCurrentThreadId())
+		    << CoroutineSuspend.Line(Location.line())
+		    << CoroutineSuspend.Awaiter(AwaiterType.data(), static_cast<int32>(AwaiterType.size()))
+		    << CoroutineSuspend.Function(Function.data(), static_cast<int32>(Function.size()))
+		    << CoroutineSuspend.File(File.data(), static_cast<int32>(File.size()));
+
+		// 再開元に実行を戻す
+		GRunningCoroutineId = State.ResumerId;
+	}
+
+	void TraceResume(FCoroutineTraceState& State)
+	{
+		if ( !IsTraceEnabled() )
+		{
+			return;
+		}
+		const uint64 Id = AssignId(State, nullptr);
+
+		UE_TRACE_LOG(Unco, CoroutineResume, UncoChannel)
+		    << CoroutineResume.Cycle(FPlatformTime::Cycles64())
+		    << CoroutineResume.CoroutineId(Id)
+		    << CoroutineResume.ThreadId(FPlatformTLS::GetCurrentThreadId())
+		    << CoroutineResume.WakerId(GRunningCoroutineId)
+		    << CoroutineResume.Reason(static_cast<uint8>(GWakeReason));
+
+		State.ResumerId     = GRunningCoroutineId;
+		GRunningCoroutineId = Id;
+
+		// 次のサスペンドまでをコルーチン関数名のCPUスコープにする
+		if ( State.FunctionName != nullptr && IsCpuTraceEnabled() )
+		{
+			State.bSpanOpen = true;
+			FCpuProfilerTrace::OutputBeginDynamicEvent(State.FunctionName);
+		}
+	}
+
+	void TraceFinish(FCoroutineTraceState& State)
+	{
+		EndSpan(State);
+		if ( State.Id == 0 || !IsTraceEnabled() )
+		{
+			return;
+		}
+
+		UE_TRACE_LOG(Unco, CoroutineFinish, UncoChannel)
+		    << CoroutineFinish.Cycle(FPlatformTime::Cycles64())
+		    << CoroutineFinish.CoroutineId(State.Id);
+
+		GRunningCoroutineId = State.ResumerId;
+	}
+
+	void TraceDestroy(FCoroutineTraceState& State)
+	{
+		if ( State.Id == 0 || !IsTraceEnabled() )
+		{
+			return;
+		}
+
+		UE_TRACE_LOG(Unco, CoroutineDestroy, UncoChannel)
+		    << CoroutineDestroy.Cycle(FPlatformTime::Cycles64())
+		    << CoroutineDestroy.CoroutineId(State.Id);
+	}
+
+	////////////////////////////////////////////////////////
+	// FTraceWakeScope
+
+	FTraceWakeScope::FTraceWakeScope(ETraceWakeReason Reason)
+	    : PrevReason(GWakeReason)
+	{
+		GWakeReason = Reason;
+	}
+
+	FTraceWakeScope::~FTraceWakeScope()
+	{
+		GWakeReason = PrevReason;
+	}
+
+	////////////////////////////////////////////////////////
+	// FTraceCpuScope
+
+	FTraceCpuScope::FTraceCpuScope(const UObject* HostObject)
+	{
+		if ( !IsCpuTraceEnabled() )
+		{
+			return;
+		}
+		bOpen = true;
+
+		const FString Name = FString::Printf(
+		    TEXT("Unco_Generator %s"), HostObject != nullptr ? *HostObject->GetName() : TEXT("None"));
+		FCpuProfilerTrace::OutputBeginDynamicEvent(*Name);
+	}
+
+	FTraceCpuScope::~FTraceCpuScope()
+	{
+		if ( bOpen )
+		{
+			FCpuProfilerTrace::OutputEndEvent();
+		}
+	}
+
+} // namespace unco::details
+
+#endif // UNCO_TRACE_ENABLED
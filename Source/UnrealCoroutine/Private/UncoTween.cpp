@@ -0,0 +1,235 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "UncoTween.h"
+
+#include "UncoScheduler.h"
+
+namespace unco::details
+{
+
+	float ApplyEasing(ETweenEasing Easing, float Alpha)
+	{
+		switch ( Easing )
+		{
+			case ETweenEasing::Linear:
+				return Alpha;
+			case ETweenEasing::EaseIn:
+				return Alpha * Alpha * Alpha;
+			case ETweenEasing::EaseOut:
+			{
+				const float Inv = 1.f - Alpha;
+				return 1.f - Inv * Inv * Inv;
+			}
+			case ETweenEasing::EaseInOut:
+				return FMath::InterpEaseInOut(0.f, 1.f, Alpha, 3.f);
+			case ETweenEasing::SinusoidalInOut:
+				return FMath::InterpSinInOut(0.f, 1.f, Alpha);
+			case ETweenEasing::SmoothStep:
+				return FMath::SmoothStep(0.f, 1.f, Alpha);
+		}
+		return Alpha;
+	}
+
+	////////////////////////////////////////////////////////
+	// FTweenNode
+
+	FTweenNode::~FTweenNode()
+	{
+		if ( TweenIndex != INDEX_NONE )
+		{
+			if ( UUncoScheduler* OwnerScheduler = Scheduler.Get() )
+			{
+				OwnerScheduler->RemoveTween(*this);
+			}
+		}
+	}
+
+	bool FTweenNode::SuspendTween(const UObject*          WorldContext,
+	                              std::coroutine_handle<> coroutine,
+	                              FApply                  InApply,
+	                              float                   Duration,
+	                              ETweenEasing            Easing)
+	{
+		UUncoScheduler* OwnerScheduler = UUncoScheduler::Get(WorldContext);
+		if ( !IsValid(OwnerScheduler) )
+		{
+			return false;
+		}
+
+		Coroutine     = coroutine;
+		Apply         = InApply;
+		ContextObject = WorldContext;
+		OwnerScheduler->AddTween(*this, Duration, Easing);
+		return true;
+	}
+
+	////////////////////////////////////////////////////////
+	// FTweenSet
+
+	FTweenSet::~FTweenSet()
+	{
+		Reset();
+	}
+
+	void FTweenSet::Add(FTweenNode& Node, UUncoScheduler* Scheduler, float Duration, ETweenEasing Easing)
+	{
+		check(Node.TweenIndex == INDEX_NONE);
+
+		Node.Scheduler = Scheduler;
+		if ( bAdvancing )
+		{
+			// 走査中の配列を伸ばさない様に進め終わるまで待たせる
+			Node.bPendingAdd = true;
+			Node.TweenIndex  = PendingAdds.Add(FPendingTween{&Node, Duration, Easing});
+			return;
+		}
+
+		Node.TweenIndex = Nodes.Add(&Node);
+		Elapsed.Add(0.f);
+		InvDuration.Add(1.f / FMath::Max(Duration, SMALL_NUMBER));
+		Alpha.Add(0.f);
+		Easings.Add(Easing);
+	}
+
+	void FTweenSet::Remove(FTweenNode& Node)
+	{
+		const int32 Index = Node.TweenIndex;
+		if ( Node.bPendingAdd )
+		{
+			check(PendingAdds.IsValidIndex(Index) && PendingAdds[Index].Node == &Node);
+			PendingAdds[Index].Node = nullptr;
+			Node.bPendingAdd        = false;
+			Node.TweenIndex         = INDEX_NONE;
+			return;
+		}
+
+		check(Nodes.IsValidIndex(Index) && Nodes[Index] == &Node);
+		if ( bAdvancing )
+		{
+			// 走査中の配列は詰めずに空にしておき、進め終わった時に取り除く
+			Nodes[Index]    = nullptr;
+			Node.TweenIndex = INDEX_NONE;
+			return;
+		}
+
+		Nodes.RemoveAtSwap(Index, 1, false);
+		Elapsed.RemoveAtSwap(Index, 1, false);
+		InvDuration.RemoveAtSwap(Index, 1, false);
+		Alpha.RemoveAtSwap(Index, 1, false);
+		Easings.RemoveAtSwap(Index, 1, false);
+		if ( Nodes.IsValidIndex(Index) )
+		{
+			Nodes[Index]->TweenIndex = Index;
+		}
+		Node.TweenIndex = INDEX_NONE;
+	}
+
+	void FTweenSet::Reset()
+	{
+		check(!bAdvancing);
+
+		for ( FTweenNode* Node : Nodes )
+		{
+			if ( Node != nullptr )
+			{
+				Node->TweenIndex = INDEX_NONE;
+			}
+		}
+		for ( const FPendingTween& Pending : PendingAdds )
+		{
+			if ( Pending.Node != nullptr )
+			{
+				Pending.Node->TweenIndex  = INDEX_NONE;
+				Pending.Node->bPendingAdd = false;
+			}
+		}
+		Nodes.Empty();
+		PendingAdds.Empty();
+		Elapsed.Empty();
+		InvDuration.Empty();
+		Alpha.Empty();
+		Easings.Empty();
+	}
+
+	void FTweenSet::Advance(float DeltaTime, TWaitList<FCoroutineWaitNode>& OutFinished)
+	{
+		const int32 Count = Nodes.Num();
+
+		// 進行度の計算は分岐の無いループにしてコンパイラーのベクトル化を効かせる
+		float* const       ElapsedData     = Elapsed.GetData();
+		const float* const InvDurationData = InvDuration.GetData();
+		float* const       AlphaData       = Alpha.GetData();
+		for ( int32 Index = 0; Index < Count; ++Index )
+		{
+			ElapsedData[Index] += DeltaTime;
+			AlphaData[Index] = FMath::Min(ElapsedData[Index] * InvDurationData[Index], 1.f);
+		}
+
+		// 値の反映
+		// 設定関数からトゥイーンが追加・削除されても配列の長さと並びは変えない
+		// ワールドコンテキストが破棄されたものは設定先も破棄されている可能性があるので反映しない
+		bAdvancing = true;
+		for ( int32 Index = 0; Index < Count; ++Index )
+		{
+			FTweenNode* Node = Nodes[Index];
+			if ( Node != nullptr && Node->ContextObject.IsValid() )
+			{
+				Node->Apply(*Node, ApplyEasing(Easings[Index], AlphaData[Index]));
+			}
+		}
+		bAdvancing = false;
+
+		// 終わったもの・削除されたものを取り除いて詰める
+		int32 WriteIndex = 0;
+		for ( int32 ReadIndex = 0; ReadIndex < Count; ++ReadIndex )
+		{
+			FTweenNode* Node = Nodes[ReadIndex];
+			if ( Node == nullptr )
+			{
+				continue;
+			}
+			// ワールドコンテキストが破棄されたものは再開せずに取り除く
+			// コルーチンはホストの破棄と共に破棄される
+			if ( !Node->ContextObject.IsValid() )
+			{
+				Node->TweenIndex = INDEX_NONE;
+				continue;
+			}
+			if ( AlphaData[ReadIndex] >= 1.f )
+			{
+				Node->TweenIndex = INDEX_NONE;
+				OutFinished.PushBack(*Node);
+				continue;
+			}
+
+			if ( WriteIndex != ReadIndex )
+			{
+				Nodes[WriteIndex]       = Node;
+				ElapsedData[WriteIndex] = ElapsedData[ReadIndex];
+				InvDuration[WriteIndex] = InvDurationData[ReadIndex];
+				AlphaData[WriteIndex]   = AlphaData[ReadIndex];
+				Easings[WriteIndex]     = Easings[ReadIndex];
+			}
+			Node->TweenIndex = WriteIndex++;
+		}
+
+		Nodes.SetNum(WriteIndex, false);
+		Elapsed.SetNum(WriteIndex, false);
+		InvDuration.SetNum(WriteIndex, false);
+		Alpha.SetNum(WriteIndex, false);
+		Easings.SetNum(WriteIndex, false);
+
+		// 進めている最中に追加されたものは次のTickから進める
+		for ( const FPendingTween& Pending : PendingAdds )
+		{
+			if ( FTweenNode* Node = Pending.Node )
+			{
+				Node->bPendingAdd = false;
+				Node->TweenIndex  = INDEX_NONE;
+				Add(*Node, Node->Scheduler.Get(), Pending.Duration, Pending.Easing);
+			}
+		}
+		PendingAdds.Reset();
+	}
+
+} // namespace unco::details
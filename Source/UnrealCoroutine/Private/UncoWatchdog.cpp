@@ -0,0 +1,189 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "UncoWatchdog.h"
+
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include "UnrealCoroutine.h"
+
+namespace unco::details
+{
+
+	namespace
+	{
+		// 保持する記録の数
+		constexpr int32 MaxLongSlices = 256;
+
+		FCriticalSection         GLongSliceLock;
+		TArray<FLongSliceRecord> GLongSlices;
+		int32                    GNextLongSlice = 0;
+
+#if UNCO_WATCHDOG_ENABLED
+
+		float GSliceThresholdMs = 0.f;
+		bool  bSliceWatchdogEnsure = false;
+
+		void OnSliceThresholdChanged(IConsoleVariable*)
+		{
+			GSliceThresholdCycles =
+			    GSliceThresholdMs > 0.f
+			        ? static_cast<uint64>(GSliceThresholdMs / 1000.0 / FPlatformTime::GetSecondsPerCycle64())
+			        : 0;
+		}
+
+		FAutoConsoleVariableRef CVarSliceWatchdogThresholdMs(
+		    TEXT("unco.SliceWatchdogThresholdMs"),
+		    GSliceThresholdMs,
+		    TEXT("コルーチンの1回の再開(次のサスペンドまで)がこの時間(ms)を超えた場合に記録します。0以下で無効"),
+		    FConsoleVariableDelegate::CreateStatic(&OnSliceThresholdChanged),
+		    ECVF_Default);
+
+		FAutoConsoleVariableRef CVarSliceWatchdogEnsure(
+		    TEXT("unco.SliceWatchdogEnsure"),
+		    bSliceWatchdogEnsure,
+		    TEXT("閾値を超えた再開を記録した時にensureを発生させます(Developmentビルドのみ)"),
+		    ECVF_Default);
+
+		void AddLongSlice(FLongSliceRecord&& Record)
+		{
+			UE_LOG(LogUnco,
+			       Warning,
+			       TEXT("Coroutine slice took %.2f ms: %s (resumed from %s at %s:%d)"),
+			       Record.DurationMs,
+			       *Record.CallSite,
+			       *Record.Awaiter,
+			       *Record.File,
+			       Record.Line);
+
+	#if !UE_BUILD_TEST
+			ensureMsgf(!bSliceWatchdogEnsure,
+			           TEXT("Coroutine slice took %.2f ms: %s"),
+			           Record.DurationMs,
+			           *Record.CallSite);
+	#endif
+
+			FScopeLock Lock(&GLongSliceLock);
+			if ( GLongSlices.Num() < MaxLongSlices )
+			{
+				GLongSlices.Add(MoveTemp(Record));
+			}
+			else
+			{
+				GLongSlices[GNextLongSlice] = MoveTemp(Record);
+			}
+			GNextLongSlice = (GNextLongSlice + 1) % MaxLongSlices;
+		}
+
+		float CyclesToMs(uint64 Cycles)
+		{
+			return static_cast<float>(FPlatformTime::ToMilliseconds64(Cycles));
+		}
+
+#endif // UNCO_WATCHDOG_ENABLED
+	} // namespace
+
+#if UNCO_WATCHDOG_ENABLED
+
+	uint64 GSliceThresholdCycles = 0;
+
+	void ReportLongSlice(const FCoroutineTraceState& State, uint64 Cycles)
+	{
+		FLongSliceRecord Record;
+		Record.CallSite    = ANSI_TO_TCHAR(State.SliceLocation.function_name());
+		Record.Awaiter     = FString(static_cast<int32>(State.SliceAwaiter.size()), State.SliceAwaiter.data());
+		Record.File        = ANSI_TO_TCHAR(State.SliceLocation.file_name());
+		Record.Line        = static_cast<int32>(State.SliceLocation.line());
+		Record.DurationMs  = CyclesToMs(Cycles);
+		Record.FrameNumber = GFrameCounter;
+		AddLongSlice(MoveTemp(Record));
+	}
+
+	void ReportLongGeneratorStep(const UObject* HostObject, uint64 Cycles)
+	{
+		FLongSliceRecord Record;
+		Record.CallSite    = HostObject != nullptr ? HostObject->GetPathName() : TEXT("None");
+		Record.Awaiter     = TEXT("co_yield");
+		Record.DurationMs  = CyclesToMs(Cycles);
+		Record.FrameNumber = GFrameCounter;
+		AddLongSlice(MoveTemp(Record));
+	}
+
+#endif // UNCO_WATCHDOG_ENABLED
+
+} // namespace unco::details
+
+namespace unco
+{
+
+	TArray<FLongSliceRecord> GetLongSlices()
+	{
+		FScopeLock Lock(&details::GLongSliceLock);
+
+		// リングバッファを古い順に並べ直す
+		TArray<FLongSliceRecord> Result;
+		Result.Reserve(details::GLongSlices.Num());
+		const int32 Start = details::GLongSlices.Num() < details::MaxLongSlices ? 0 : details::GNextLongSlice;
+		for ( int32 Index = 0; Index < details::GLongSlices.Num(); ++Index )
+		{
+			Result.Add(details::GLongSlices[(Start + Index) % details::GLongSlices.Num()]);
+		}
+		return Result;
+	}
+
+	void DumpLongSlices(FOutputDevice& Ar)
+	{
+		Ar.Logf(TEXT("%10s %10s  %s"), TEXT("Frame"), TEXT("Ms"), TEXT("CallSite / Awaiter"));
+		for ( const FLongSliceRecord& Record : GetLongSlices() )
+		{
+			Ar.Logf(TEXT("%10llu %10.2f  %s"), Record.FrameNumber, Record.DurationMs, *Record.CallSite);
+			Ar.Logf(TEXT("%10s %10s    <- %s (%s:%d)"), TEXT(""), TEXT(""), *Record.Awaiter, *Record.File, Record.Line);
+		}
+	}
+
+	bool WriteLongSlicesCsv(const FString& Filename)
+	{
+		// CSVのフィールドとしてエスケープする
+		const auto Escape = [](const FString& Field)
+		{
+			return FString::Printf(TEXT("\"%s\""), *Field.Replace(TEXT("\""), TEXT("\"\"")));
+		};
+
+		FString Csv = TEXT("Frame,DurationMs,CallSite,Awaiter,File,Line\n");
+		for ( const FLongSliceRecord& Record : GetLongSlices() )
+		{
+			Csv += FString::Printf(TEXT("%llu,%.3f,%s,%s,%s,%d\n"),
+			                       Record.FrameNumber,
+			                       Record.DurationMs,
+			                       *Escape(Record.CallSite),
+			                       *Escape(Record.Awaiter),
+			                       *Escape(Record.File),
+			                       Record.Line);
+		}
+		return FFileHelper::SaveStringToFile(Csv, *Filename);
+	}
+
+	namespace
+	{
+		FAutoConsoleCommandWithOutputDevice GDumpLongSlicesCommand(
+		    TEXT("unco.DumpLongSlices"),
+		    TEXT("閾値を超えたコルーチンの再開を出力します"),
+		    FConsoleCommandWithOutputDeviceDelegate::CreateStatic(&DumpLongSlices));
+
+		FAutoConsoleCommand GWriteLongSlicesCsvCommand(
+		    TEXT("unco.WriteLongSlicesCsv"),
+		    TEXT("閾値を超えたコルーチンの再開をCSVに書き出します。引数で出力先を指定出来ます"),
+		    FConsoleCommandWithArgsDelegate::CreateLambda(
+		        [](const TArray<FString>& Args)
+		        {
+			        const FString Filename =
+			            Args.Num() > 0 ? Args[0] : FPaths::ProfilingDir() / TEXT("UncoLongSlices.csv");
+			        if ( WriteLongSlicesCsv(Filename) )
+			        {
+				        UE_LOG(LogUnco, Display, TEXT("Wrote long coroutine slices to %s"), *Filename);
+			        }
+		        }));
+	} // namespace
+
+} // namespace unco
@@ -1,7 +1,8 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "UncoObjectTask.h"
-#include "UncoScheduler.h"
+#include "UncoTaskRegistry.h"
+#include "UncoTaskScope.h"
 
 namespace unco
 {
@@ -12,25 +13,39 @@ namespace unco
 		// 終了フラグを建てる
 		Promise.bFinalized = true;
 
-		if ( Promise.bRegister )
+#if UNCO_WATCHDOG_ENABLED
+		details::EndSlice(Promise.Trace);
+#endif
+#if UNCO_TRACE_ENABLED
+		details::TraceFinish(Promise.Trace);
+#endif
+
+		if ( Promise.Scope != nullptr )
+		{
+			// スコープに所有されている場合にはスコープに通知する
+			// 破棄はスコープがまとめて行う
+			Promise.Scope->OnChildFinished();
+			return;
+		}
+
+		if ( Promise.Registry != nullptr )
 		{
 			// スケジューラーに登録されている場合には
 			// スケジューラーに解除させる
 			// スケジューラー経由でdestoryを呼ばせる
-			UUncoScheduler* Scheduler =
-			    UUncoScheduler::Get(Promise.HostObject.Get());
-			if ( IsValid(Scheduler) )
-			{
-				Scheduler->UnregisterTask(
-				    Promise.HostObject,
-				    std::coroutine_handle<FObjectTaskPromise>::from_promise(
-				        Promise));
-			}
+			// ホストオブジェクトのワールドのスケジューラーとは限らないので登録先を使う
+			Promise.Registry->OnTaskFinished();
 		}
 	}
 
 	FObjectTask::~FObjectTask()
 	{
+		if ( !CoroutineHandle )
+		{
+			// FTaskScopeに所有権が移動している
+			return;
+		}
+
 		if ( CoroutineHandle.promise().bFinalized )
 		{
 			// すでに終了している場合には
@@ -49,11 +64,9 @@ namespace unco
 		{
 			// スケジューラーに保持させる
 			// スケジューラー経由でdestoryを呼ばせる
-			UUncoScheduler* Scheduler = UUncoScheduler::Get(HostObject.Get());
-			if ( IsValid(Scheduler) )
+			if ( details::FTaskRegistry* Registry = details::FindTaskRegistry(HostObject.Get()) )
 			{
-				Scheduler->RegisterTask(HostObject, CoroutineHandle);
-				CoroutineHandle.promise().bRegister = true;
+				Registry->Register(HostObject, CoroutineHandle);
 			}
 		}
 		else
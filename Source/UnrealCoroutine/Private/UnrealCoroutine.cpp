@@ -3,4 +3,6 @@
 #include "UnrealCoroutine.h"
 #include "Modules/ModuleManager.h"
 
+DEFINE_LOG_CATEGORY(LogUnco);
+
 IMPLEMENT_MODULE(FDefaultGameModuleImpl, UnrealCoroutine)
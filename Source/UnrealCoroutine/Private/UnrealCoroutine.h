@@ -2,7 +2,11 @@
 
 #pragma once
 
-#include "CoreMinimal.h"
-#include "Stats/Stats.h"
+#include "UncoCoreMinimal.h"
+#if !UNCO_STANDALONE
+	#include "Stats/Stats.h"
+#endif
 
 DECLARE_STATS_GROUP(TEXT("Unco"), STATGROUP_Unco, STATCAT_Advanced);
+
+DECLARE_LOG_CATEGORY_EXTERN(LogUnco, Log, All);
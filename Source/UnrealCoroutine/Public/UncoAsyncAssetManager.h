@@ -0,0 +1,158 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+// AssetManagerの非同期関数を記述する
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/StreamableManager.h"
+#include "UObject/PrimaryAssetId.h"
+#include "UncoProgress.h"
+#include "UncoScheduler.h"
+#include <coroutine>
+
+class UObject;
+
+namespace unco::details
+{
+
+	/**
+	 * @brief プライマリアセットの読み込み・バンドル状態の変更待機の基底
+	 *
+	 * UAssetManagerにリクエストする為、ハンドルの共有・優先度・メモリの計上はAssetManagerの管理下で行われる。
+	 * 完了はスケジューラーのTickで確認し、その際に進捗も更新する。
+	 * 読み込まれたアセットはAssetManagerが保持し続けるので、不要になったらUnloadPrimaryAssetsで解放する事。
+	*/
+	struct UNREALCOROUTINE_API FPrimaryAssetsAwaiterBase : private FTickWaitNode
+	{
+		enum class EMode : uint8
+		{
+			// 読み込む
+			Load,
+			// 読み込み済みのアセットのバンドル状態を変更する
+			ChangeBundleState,
+		};
+
+		FPrimaryAssetsAwaiterBase(const UObject*          InWorldContext,
+		                          TArray<FPrimaryAssetId> InAssetIds,
+		                          TArray<FName>           InAddBundles,
+		                          TArray<FName>           InRemoveBundles,
+		                          bool                    bInRemoveAllBundles,
+		                          EMode                   InMode,
+		                          TAsyncLoadPriority      InPriority,
+		                          FAsyncProgress*         InProgress);
+
+		// 読み込みをリクエストし、既に完了している場合は待機しない
+		bool await_ready();
+		// スケジューラーが無い場合は中断しない
+		bool await_suspend(std::coroutine_handle<> coroutine);
+
+	protected:
+		// 読み込まれたプライマリアセット(AssetIdsと同じ順番、失敗した場合はnullptr)
+		TArray<UObject*> GetLoadedObjects() const;
+
+	private:
+		static bool OnTickLoad(FTickWaitNode& Node, float DeltaTime);
+
+		// 読み込みが終わっているか？
+		bool IsCompleted() const;
+		void UpdateProgress(float Value) const;
+
+		FWeakObjectPtr                WorldContext;
+		TArray<FPrimaryAssetId>       AssetIds;
+		TArray<FName>                 AddBundles;
+		TArray<FName>                 RemoveBundles;
+		TSharedPtr<FStreamableHandle> Handle;
+		FAsyncProgress*               Progress;
+		TAsyncLoadPriority            Priority;
+		EMode                         Mode;
+		bool                          bRemoveAllBundles;
+	};
+
+	/**
+	 * @brief プライマリアセットの読み込み・バンドル状態の変更待機
+	*/
+	template<class T>
+	struct TPrimaryAssetsAwaiter : public FPrimaryAssetsAwaiterBase
+	{
+		using FPrimaryAssetsAwaiterBase::FPrimaryAssetsAwaiterBase;
+
+		[[nodiscard]] TArray<T*> await_resume() const
+		{
+			TArray<T*> Result;
+			TArray<UObject*> Objects = GetLoadedObjects();
+			Result.Reserve(Objects.Num());
+			for ( UObject* Object : Objects )
+			{
+				Result.Add(Cast<T>(Object));
+			}
+			return Result;
+		}
+	};
+
+} // namespace unco::details
+
+namespace unco
+{
+
+	/**
+	 * @brief プライマリアセットをAssetManager経由で非同期に読み込みます
+	 *
+	 * UAssetManager::LoadPrimaryAssetsを使用する為、他の読み込みとハンドルが共有され優先度も反映されます。
+	 * @param WorldContextObject ワールドコンテキスト
+	 * @param AssetIds 読み込むプライマリアセット
+	 * @param Bundles 一緒に読み込むバンドル
+	 * @param Progress 進捗の出力先(省略可)
+	 * @param Priority 読み込みの優先度
+	 * @return 読み込まれたアセット(AssetIdsと同じ順番、失敗した場合はnullptr)
+	 */
+	template<class T = UObject>
+	details::TPrimaryAssetsAwaiter<T> AsyncLoadPrimaryAssets(
+	    const UObject*          WorldContextObject,
+	    TArray<FPrimaryAssetId> AssetIds,
+	    TArray<FName>           Bundles  = TArray<FName>(),
+	    FAsyncProgress*         Progress = nullptr,
+	    TAsyncLoadPriority      Priority = FStreamableManager::DefaultAsyncLoadPriority)
+	{
+		return details::TPrimaryAssetsAwaiter<T>(WorldContextObject,
+		                                         MoveTemp(AssetIds),
+		                                         MoveTemp(Bundles),
+		                                         TArray<FName>(),
+		                                         false,
+		                                         details::FPrimaryAssetsAwaiterBase::EMode::Load,
+		                                         Priority,
+		                                         Progress);
+	}
+
+	/**
+	 * @brief 読み込み済みのプライマリアセットのバンドル状態を非同期で変更します
+	 *
+	 * UAssetManager::ChangeBundleStateForPrimaryAssetsを使用し、追加したバンドルの読み込みが終わった時点で再開します。
+	 * @param WorldContextObject ワールドコンテキスト
+	 * @param AssetIds 変更するプライマリアセット
+	 * @param AddBundles 追加するバンドル
+	 * @param RemoveBundles 解除するバンドル
+	 * @param bRemoveAllBundles trueの場合はAddBundles以外の全てのバンドルを解除します
+	 * @param Progress 進捗の出力先(省略可)
+	 * @param Priority 読み込みの優先度
+	 * @return プライマリアセット(AssetIdsと同じ順番、読み込まれていない場合はnullptr)
+	 */
+	template<class T = UObject>
+	details::TPrimaryAssetsAwaiter<T> AsyncChangeBundleState(
+	    const UObject*          WorldContextObject,
+	    TArray<FPrimaryAssetId> AssetIds,
+	    TArray<FName>           AddBundles,
+	    TArray<FName>           RemoveBundles,
+	    bool                    bRemoveAllBundles = false,
+	    FAsyncProgress*         Progress          = nullptr,
+	    TAsyncLoadPriority      Priority          = FStreamableManager::DefaultAsyncLoadPriority)
+	{
+		return details::TPrimaryAssetsAwaiter<T>(WorldContextObject,
+		                                         MoveTemp(AssetIds),
+		                                         MoveTemp(AddBundles),
+		                                         MoveTemp(RemoveBundles),
+		                                         bRemoveAllBundles,
+		                                         details::FPrimaryAssetsAwaiterBase::EMode::ChangeBundleState,
+		                                         Priority,
+		                                         Progress);
+	}
+
+} // namespace unco
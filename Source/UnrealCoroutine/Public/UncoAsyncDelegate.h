@@ -0,0 +1,443 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+// デリゲートの非同期待機を記述する
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UncoMemory.h"
+#include "UncoWaitList.h"
+#include <coroutine>
+#include <type_traits>
+#include <utility>
+
+class UObject;
+
+namespace unco::details
+{
+
+	/**
+	 * @brief デリゲート待機ノード
+	 *
+	 * 待機中のAwaiter自身がノードとなり待機リストに登録される。
+	 * Coroutineが無効の場合は待機終了時に再開を行わない。(OnBroadcast内で処理する)
+	*/
+	struct FDelegateWaitNode : public FWaitNode
+	{
+		/**
+		 * ブロードキャスト時に呼ばれる
+		 * @param Node 待機ノード
+		 * @param Payload ブロードキャストの引数
+		 * @return trueの場合はコルーチンを再開する
+		 */
+		using FOnBroadcast = bool (*)(FDelegateWaitNode& Node, const void* Payload);
+
+		FOnBroadcast            OnBroadcast = nullptr;
+		std::coroutine_handle<> Coroutine;
+	};
+
+	/**
+	 * @brief ダイナミックデリゲートのブロードキャスト引数
+	*/
+	struct FDynamicDelegatePayload
+	{
+		// シグネチャの各引数のオフセット
+		const int32* ParamOffsets = nullptr;
+		int32        NumParams    = 0;
+		// ProcessEventに渡された引数バッファ
+		uint8* Parms = nullptr;
+	};
+
+	/**
+	 * @brief イベントソース毎の待機リスト
+	 *
+	 * デリゲートには待機者の数に関わらず1度だけバインドし、
+	 * ブロードキャスト時に待機リストを走査して再開する。
+	*/
+	class UNREALCOROUTINE_API FDelegateWaitListBase
+	{
+	public:
+		FDelegateWaitListBase(const UObject* InOwner, const void* InDelegate);
+		virtual ~FDelegateWaitListBase();
+
+		// コピー禁止+ムーブ禁止
+		FDelegateWaitListBase(const FDelegateWaitListBase&) = delete;
+		void operator=(const FDelegateWaitListBase&) = delete;
+
+		// デリゲートを保持するオブジェクトが破棄されているか？
+		bool IsStale() const;
+
+		// 待機者が存在しないか？
+		bool IsEmpty() const
+		{
+			return Waiters.IsEmpty();
+		}
+
+		// ブロードキャスト中か？
+		// 再開したコルーチンから待機の追加・破棄が行われても、この間は待機リストを解放しない
+		bool IsBroadcasting() const
+		{
+			return BroadcastDepth > 0;
+		}
+
+		// 待機者を追加する
+		void Add(FDelegateWaitNode& Node)
+		{
+			Waiters.PushBack(Node);
+		}
+
+		// デリゲートのバインドを解除する
+		virtual void Unbind() = 0;
+
+	protected:
+		// 待機者にブロードキャストを通知する
+		void Broadcast(const void* Payload);
+
+	private:
+		FWeakObjectPtr                Owner;
+		const void*                   Delegate;
+		TWaitList<FDelegateWaitNode>  Waiters;
+		int32                         BroadcastDepth = 0;
+		bool                          bHasOwner      = false;
+	};
+
+	/**
+	 * @brief 登録済みの待機リストを検索する
+	 * 所有オブジェクトが破棄されている待機リストはこの時点で破棄される
+	 * @param Delegate デリゲートのアドレス
+	*/
+	UNREALCOROUTINE_API FDelegateWaitListBase* FindDelegateWaitList(const void* Delegate);
+
+	/**
+	 * @brief 待機リストを登録する
+	 * @param Delegate デリゲートのアドレス
+	 * @param WaitList 待機リスト
+	*/
+	UNREALCOROUTINE_API FDelegateWaitListBase* RegisterDelegateWaitList(
+	    const void*                         Delegate,
+	    TUniquePtr<FDelegateWaitListBase>&& WaitList);
+
+	/**
+	 * @brief 待機者がいなくなった待機リストを解放する
+	 * ブロードキャスト中は何もせず、ブロードキャストの終了時に解放される
+	 * @param Delegate デリゲートのアドレス
+	*/
+	UNREALCOROUTINE_API void ReleaseDelegateWaitList(const void* Delegate);
+
+	/**
+	 * @brief ダイナミックマルチキャストデリゲートの待機リストを作成する
+	 * @param Owner デリゲートを保持するオブジェクト
+	 * @param Delegate デリゲート
+	 * @param NumParams 待機側が想定している引数の数
+	*/
+	UNREALCOROUTINE_API TUniquePtr<FDelegateWaitListBase> MakeDynamicDelegateWaitList(
+	    const UObject*            Owner,
+	    FMulticastScriptDelegate& Delegate,
+	    int32                     NumParams);
+
+	/**
+	 * @brief ダイナミックマルチキャストデリゲートの待機者を登録する
+	 * @param Owner デリゲートを保持するオブジェクト
+	 * @param Delegate デリゲート
+	 * @param NumParams 待機側が想定している引数の数
+	 * @param Node 待機ノード
+	 * @return 登録出来たか？
+	*/
+	UNREALCOROUTINE_API bool AddDynamicDelegateWaiter(const UObject*            Owner,
+	                                                  FMulticastScriptDelegate& Delegate,
+	                                                  int32                     NumParams,
+	                                                  FDelegateWaitNode&        Node);
+
+	/**
+	 * @brief 待機者の登録を解除する
+	 * 待機者がいなくなった場合にはデリゲートのバインドも解除される
+	 * @param Delegate デリゲートのアドレス
+	 * @param Node 待機ノード
+	*/
+	UNREALCOROUTINE_API void RemoveDelegateWaiter(const void* Delegate, FDelegateWaitNode& Node);
+
+	/**
+	 * @brief ネイティブマルチキャストデリゲートの待機リスト
+	*/
+	template<class TDelegate, class... ArgTypes>
+	class TNativeDelegateWaitList final : public FDelegateWaitListBase
+	{
+	public:
+		TNativeDelegateWaitList(const UObject* InOwner, TDelegate& InDelegate)
+		    : FDelegateWaitListBase(InOwner, &InDelegate)
+		    , Delegate(InDelegate)
+		{
+			Handle = Delegate.AddRaw(this, &TNativeDelegateWaitList::OnBroadcast);
+		}
+
+		virtual void Unbind() override
+		{
+			Delegate.Remove(Handle);
+			Handle.Reset();
+		}
+
+	private:
+		void OnBroadcast(ArgTypes... Args)
+		{
+			TTuple<ArgTypes&...> Payload(Args...);
+			Broadcast(&Payload);
+		}
+
+		TDelegate&      Delegate;
+		FDelegateHandle Handle;
+	};
+
+	/**
+	 * @brief ネイティブマルチキャストデリゲートの特性
+	*/
+	template<class... ArgTypes>
+	struct TNativeDelegateTraits
+	{
+		static constexpr int32 NumParams = sizeof...(ArgTypes);
+
+		template<class TDelegate>
+		static TUniquePtr<FDelegateWaitListBase> MakeWaitList(const UObject* Owner,
+		                                                      TDelegate&     Delegate)
+		{
+			return MakeUnique<TNativeDelegateWaitList<TDelegate, ArgTypes...>>(Owner,
+			                                                                   Delegate);
+		}
+
+		// ブロードキャストの引数を展開して関数を呼ぶ
+		template<class FuncType>
+		static decltype(auto) Apply(const void* Payload, FuncType&& Func)
+		{
+			return static_cast<const TTuple<ArgTypes&...>*>(Payload)->ApplyAfter(
+			    Forward<FuncType>(Func));
+		}
+	};
+
+	/**
+	 * @brief ダイナミックマルチキャストデリゲートの特性
+	*/
+	template<class... ArgTypes>
+	struct TDynamicDelegateTraits
+	{
+		static constexpr int32 NumParams = sizeof...(ArgTypes);
+
+		template<class TDelegate>
+		static TUniquePtr<FDelegateWaitListBase> MakeWaitList(const UObject* Owner,
+		                                                      TDelegate&     Delegate)
+		{
+			return MakeDynamicDelegateWaitList(Owner, Delegate, NumParams);
+		}
+
+		// ブロードキャストの引数を展開して関数を呼ぶ
+		template<class FuncType>
+		static decltype(auto) Apply(const void* Payload, FuncType&& Func)
+		{
+			return ApplyImpl(*static_cast<const FDynamicDelegatePayload*>(Payload),
+			                 Forward<FuncType>(Func),
+			                 std::index_sequence_for<ArgTypes...>{});
+		}
+
+	private:
+		template<class FuncType, size_t... Indices>
+		static decltype(auto) ApplyImpl(const FDynamicDelegatePayload& Payload,
+		                                FuncType&&                     Func,
+		                                std::index_sequence<Indices...>)
+		{
+			return Func(*reinterpret_cast<std::decay_t<ArgTypes>*>(
+			    Payload.Parms + Payload.ParamOffsets[Indices])...);
+		}
+	};
+
+	// デリゲート型から特性を推論する
+	template<class UserPolicy, class... ArgTypes>
+	TNativeDelegateTraits<ArgTypes...> DeduceDelegateTraits(
+	    TMulticastDelegate<void(ArgTypes...), UserPolicy>*);
+
+	template<class TWeakPtr, class... ArgTypes>
+	TDynamicDelegateTraits<ArgTypes...> DeduceDelegateTraits(
+	    TBaseDynamicMulticastDelegate<TWeakPtr, void, ArgTypes...>*);
+
+	template<class TDelegate>
+	using TDelegateTraits =
+	    decltype(DeduceDelegateTraits(static_cast<TDelegate*>(nullptr)));
+
+	// 待機結果の型
+	// 引数が無い場合はvoid、1つの場合はその型、複数の場合はTTuple
+	template<class... ArgTypes>
+	struct TDelegateResult
+	{
+		using Type = TTuple<std::decay_t<ArgTypes>...>;
+	};
+	template<class ArgType>
+	struct TDelegateResult<ArgType>
+	{
+		using Type = std::decay_t<ArgType>;
+	};
+	template<>
+	struct TDelegateResult<>
+	{
+		using Type = void;
+	};
+
+	template<class... ArgTypes>
+	typename TDelegateResult<ArgTypes...>::Type DeduceDelegateResult(
+	    TNativeDelegateTraits<ArgTypes...>*);
+	template<class... ArgTypes>
+	typename TDelegateResult<ArgTypes...>::Type DeduceDelegateResult(
+	    TDynamicDelegateTraits<ArgTypes...>*);
+
+	/**
+	 * @brief フィルター無し
+	*/
+	struct FAcceptAnyPayload
+	{
+		template<class... ArgTypes>
+		constexpr bool operator()(ArgTypes&&...) const noexcept
+		{
+			return true;
+		}
+	};
+
+	/**
+	 * @brief デリゲートのブロードキャスト待機
+	 *
+	 * 自身が待機ノードとなる為、待機でヒープ確保は発生しない。
+	 * (イベントソース毎の最初の待機時のみ待機リストが作成される)
+	*/
+	template<class TDelegate, class TFilter = FAcceptAnyPayload>
+	struct TDelegateAwaiter : private FDelegateWaitNode
+	{
+		using FTraits = TDelegateTraits<TDelegate>;
+		using FResult = decltype(DeduceDelegateResult(static_cast<FTraits*>(nullptr)));
+
+		TDelegateAwaiter(const UObject* InOwner, TDelegate& InDelegate, TFilter InFilter)
+		    : Owner(InOwner)
+		    , Delegate(&InDelegate)
+		    , Filter(MoveTemp(InFilter))
+		{
+		}
+
+		~TDelegateAwaiter()
+		{
+			if ( IsLinked() )
+			{
+				// 待機中に破棄された場合は登録を解除する
+				Unlink();
+				ReleaseDelegateWaitList(Delegate);
+			}
+		}
+
+		constexpr bool await_ready() const noexcept
+		{
+			return false;
+		}
+
+		// 待機リストを作成出来なかった場合は中断しない
+		bool await_suspend(std::coroutine_handle<> InCoroutine)
+		{
+			Coroutine   = InCoroutine;
+			OnBroadcast = &TDelegateAwaiter::HandleBroadcast;
+
+			FDelegateWaitListBase* WaitList = FindDelegateWaitList(Delegate);
+			if ( WaitList == nullptr )
+			{
+				// このイベントソースへの最初の待機なのでデリゲートにバインドする
+				UNCO_LLM_SCOPE();
+				WaitList = RegisterDelegateWaitList(
+				    Delegate, FTraits::MakeWaitList(Owner, *Delegate));
+			}
+			if ( WaitList == nullptr )
+			{
+				return false;
+			}
+			WaitList->Add(*this);
+			return true;
+		}
+
+		// 待機出来なかった場合は既定値を返す
+		FResult await_resume()
+		{
+			if constexpr ( !std::is_void_v<FResult> )
+			{
+				if ( !Result.IsSet() )
+				{
+					return FResult{};
+				}
+				return MoveTemp(Result.GetValue());
+			}
+		}
+
+	private:
+		using FStorage = std::conditional_t<std::is_void_v<FResult>, bool, FResult>;
+
+		static bool HandleBroadcast(FDelegateWaitNode& Node, const void* Payload)
+		{
+			TDelegateAwaiter& Self = static_cast<TDelegateAwaiter&>(Node);
+			return FTraits::Apply(Payload,
+			                      [&Self](auto&&... Args)
+			                      {
+				                      if ( !Self.Filter(Args...) )
+				                      {
+					                      return false;
+				                      }
+				                      if constexpr ( sizeof...(Args) == 1 )
+				                      {
+					                      Self.Result.Emplace(Args...);
+				                      }
+				                      else if constexpr ( sizeof...(Args) > 1 )
+				                      {
+					                      Self.Result.Emplace(MakeTuple(Args...));
+				                      }
+				                      return true;
+			                      });
+		}
+
+		const UObject*     Owner;
+		TDelegate*         Delegate;
+		TFilter            Filter;
+		TOptional<FStorage> Result;
+	};
+
+} // namespace unco::details
+
+namespace unco
+{
+
+	/**
+	 * @brief デリゲートのブロードキャストを非同期で待機します
+	 *
+	 * ネイティブ・ダイナミック両方のマルチキャストデリゲートに対応しています。
+	 * 同じデリゲートを待機するコルーチンが複数あってもバインドは1度だけ行われます。
+	 * @param Object デリゲートを保持するオブジェクト
+	 * @param Delegate 待機するデリゲートのメンバーポインタ
+	 * @param Filter ブロードキャストの引数を受け取り、trueを返した場合のみ再開します(省略可)
+	 * @return ブロードキャストの引数
+	 */
+	template<class TObject,
+	         class TClass,
+	         class TDelegate,
+	         class TFilter = details::FAcceptAnyPayload>
+	details::TDelegateAwaiter<TDelegate, TFilter> WaitForDelegate(TObject* Object,
+	                                                              TDelegate TClass::*Delegate,
+	                                                              TFilter Filter = {})
+	{
+		static_assert(std::is_base_of_v<UObject, TObject>,
+		              "WaitForDelegate requires a UObject owner");
+		return details::TDelegateAwaiter<TDelegate, TFilter>(
+		    Object, Object->*Delegate, MoveTemp(Filter));
+	}
+
+	/**
+	 * @brief 静的なデリゲートのブロードキャストを非同期で待機します
+	 *
+	 * 所有オブジェクトの寿命を追跡しない為、待機中にデリゲートが破棄されない必要があります。
+	 * @param Delegate 待機するデリゲート
+	 * @param Filter ブロードキャストの引数を受け取り、trueを返した場合のみ再開します(省略可)
+	 * @return ブロードキャストの引数
+	 */
+	template<class TDelegate, class TFilter = details::FAcceptAnyPayload>
+	details::TDelegateAwaiter<TDelegate, TFilter> WaitForDelegate(TDelegate& Delegate,
+	                                                              TFilter   Filter = {})
+	{
+		return details::TDelegateAwaiter<TDelegate, TFilter>(
+		    nullptr, Delegate, MoveTemp(Filter));
+	}
+
+} // namespace unco
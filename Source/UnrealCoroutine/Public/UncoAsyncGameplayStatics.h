@@ -3,35 +3,293 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Engine/EngineTypes.h"
+#include "GameFramework/GameModeBase.h"
+#include "UncoAsyncDelegate.h"
+#include "UncoFrameBudget.h"
+#include "UncoProgress.h"
+#include "UncoScheduler.h"
 #include <coroutine>
 
 class UObject;
+class AActor;
 class AGameModeBase;
+class ULevelStreaming;
+class USaveGame;
+struct FStreamableHandle;
 
 namespace unco::details
 {
 	/**
 	 * @brief 非同期GameMode取得待機オブジェクト
+	 *
+	 * ゲームモードの初期化イベントへのバインドは待機者全体で1つだけ行われる。
 	*/
 	struct UNREALCOROUTINE_API FGetGameModeAwaiter
 	{
+		/**
+		 * @brief 同じワールドのゲームモードのみ受け付けるフィルター
+		*/
+		struct UNREALCOROUTINE_API FSameWorldFilter
+		{
+			bool operator()(AGameModeBase* NewGameMode) const;
+
+			FWeakObjectPtr WorldContext;
+		};
+
+		using FInitializedAwaiter =
+		    TDelegateAwaiter<FGameModeEvents::FGameModeInitializedEvent,
+		                     FSameWorldFilter>;
+
 		FGetGameModeAwaiter(const UObject* InWorldContext);
-		~FGetGameModeAwaiter();
 		bool await_ready() const noexcept
 		{
 			// ゲームモードが無い場合には待機が発生します。
 			return GameMode != nullptr;
 		}
-		void await_suspend(std::coroutine_handle<> coroutine);
-		constexpr [[nodiscard]] AGameModeBase* await_resume() const noexcept
+		bool await_suspend(std::coroutine_handle<> coroutine)
+		{
+			return InitializedAwaiter.await_suspend(coroutine);
+		}
+		[[nodiscard]] AGameModeBase* await_resume()
 		{
+			if ( GameMode == nullptr )
+			{
+				GameMode = InitializedAwaiter.await_resume();
+			}
 			return GameMode;
 		}
 
 	private:
-		FWeakObjectPtr  WorldContext = nullptr;
-		AGameModeBase*  GameMode     = nullptr;
-		FDelegateHandle Handle;
+		AGameModeBase*      GameMode = nullptr;
+		FInitializedAwaiter InitializedAwaiter;
+	};
+
+	/**
+	 * @brief 分散アクタースポーン待機オブジェクト
+	 *
+	 * クラスを非同期ロードした後、1フレームの処理量に収まる分だけ
+	 * 遅延スポーンを行い全てのスポーンが終わったら再開する。
+	*/
+	struct UNREALCOROUTINE_API FSpawnActorsAwaiterBase : private FTickWaitNode
+	{
+		/**
+		 * FinishSpawningの前に呼ばれる初期化処理
+		 * @param Actor 遅延スポーンされたアクター
+		 * @param Index Transforms上の位置
+		 */
+		using FPreFinishSpawning = TFunction<void(AActor* Actor, int32 Index)>;
+
+		FSpawnActorsAwaiterBase(const UObject*                     InWorldContext,
+		                        FSoftObjectPath                    InClass,
+		                        TArray<FTransform>                 InTransforms,
+		                        FFrameBudget                       InBudget,
+		                        ESpawnActorCollisionHandlingMethod InCollisionHandling,
+		                        AActor*                            InOwner,
+		                        FPreFinishSpawning                 InPreFinishSpawning);
+		~FSpawnActorsAwaiterBase();
+
+		bool await_ready() const noexcept
+		{
+			// スポーンするものが無い場合は待機しない
+			return Transforms.Num() == 0;
+		}
+		// スケジューラーが無い場合は何もスポーンせずに中断しない
+		bool await_suspend(std::coroutine_handle<> coroutine);
+
+	protected:
+		// スポーン結果を取り出す
+		TArray<AActor*> ConsumeSpawnedActors();
+
+	private:
+		static bool OnTickSpawn(FTickWaitNode& Node, float DeltaTime);
+		// クラスのロードが終わっているか？
+		bool UpdateLoading();
+		// 1フレーム分のスポーンを行う
+		// 全てのスポーンが終わった場合はtrueを返す
+		bool UpdateSpawning();
+
+		FWeakObjectPtr                     WorldContext;
+		FSoftObjectPath                    ClassPath;
+		TArray<FTransform>                 Transforms;
+		FFrameBudget                       Budget;
+		ESpawnActorCollisionHandlingMethod CollisionHandling;
+		TWeakObjectPtr<AActor>             Owner;
+		FPreFinishSpawning                 PreFinishSpawning;
+		TSharedPtr<FStreamableHandle>      LoadHandle;
+		TWeakObjectPtr<UClass>             ActorClass;
+		TArray<TWeakObjectPtr<AActor>>     SpawnedActors;
+	};
+
+	/**
+	 * @brief 分散アクタースポーン待機
+	*/
+	template<class T>
+	struct TSpawnActorsAwaiter : public FSpawnActorsAwaiterBase
+	{
+		using FSpawnActorsAwaiterBase::FSpawnActorsAwaiterBase;
+
+		[[nodiscard]] TArray<T*> await_resume()
+		{
+			TArray<T*> Result;
+			TArray<AActor*> Actors = ConsumeSpawnedActors();
+			Result.Reserve(Actors.Num());
+			for ( AActor* Actor : Actors )
+			{
+				Result.Add(Cast<T>(Actor));
+			}
+			return Result;
+		}
+	};
+
+	/**
+	 * @brief ストリーミングレベルの読み込み・破棄待機オブジェクト
+	 *
+	 * ULevelStreamingのデリゲートで完了を検知し、スケジューラーの再開キュー経由で再開する。
+	 * 複数のレベルを指定した場合は全てのレベルが完了した時点で1度だけ再開する。
+	*/
+	struct UNREALCOROUTINE_API FStreamLevelAwaiter
+	{
+		enum class EMode : uint8
+		{
+			// 読み込みのみ
+			Load,
+			// 読み込んで表示する
+			LoadAndShow,
+			// 破棄する
+			Unload,
+		};
+
+		FStreamLevelAwaiter(const UObject*  InWorldContext,
+		                    TArray<FName>   InLevelNames,
+		                    EMode           InMode,
+		                    bool            bInShouldBlock,
+		                    FAsyncProgress* InProgress);
+		~FStreamLevelAwaiter();
+
+		// ストリーミングをリクエストし、全て完了済みであれば待機しない
+		bool           await_ready();
+		// スケジューラーが無い場合は中断しない
+		bool           await_suspend(std::coroutine_handle<> coroutine);
+		constexpr void await_resume() const noexcept {}
+
+	private:
+		struct FLevelNode : public FDelegateWaitNode
+		{
+			FStreamLevelAwaiter* Awaiter  = nullptr;
+			const void*          Delegate = nullptr;
+		};
+
+		struct FProgressNode : public FTickWaitNode
+		{
+			FStreamLevelAwaiter* Awaiter = nullptr;
+		};
+
+		static bool OnLevelEvent(FDelegateWaitNode& Node, const void* Payload);
+		static bool OnTickProgress(FTickWaitNode& Node, float DeltaTime);
+
+		// レベルが目的の状態になっているか？
+		bool IsLevelDone(const ULevelStreaming* Level) const;
+		// ストリーミングをリクエストする
+		void RequestStreaming(ULevelStreaming* Level) const;
+		// 待機しているデリゲート
+		FMulticastScriptDelegate& GetLevelEvent(ULevelStreaming* Level) const;
+		void UpdateProgress();
+
+		FWeakObjectPtr                          WorldContext;
+		TArray<FName>                           LevelNames;
+		TArray<TWeakObjectPtr<ULevelStreaming>> Levels;
+		TArray<FLevelNode>                      Nodes;
+		FCoroutineWaitNode                      ResumeNode;
+		FProgressNode                           ProgressNode;
+		TWeakObjectPtr<UUncoScheduler>          Scheduler;
+		FAsyncProgress*                         Progress   = nullptr;
+		int32                                   NumPending = 0;
+		EMode                                   Mode;
+		bool                                    bShouldBlock;
+	};
+
+	/**
+	 * @brief セーブデータの非同期処理の基底
+	 *
+	 * ワーカースレッドとの共有状態を持ち、ワーカーでの処理完了後に
+	 * ゲームスレッドからスケジューラーの再開キュー経由で再開する。
+	 * 待機中に破棄された場合は結果は破棄される。
+	*/
+	struct UNREALCOROUTINE_API FSaveGameAwaiterBase : private FCoroutineWaitNode
+	{
+		struct FTaskState;
+
+		FSaveGameAwaiterBase(const UObject* InWorldContext,
+		                     FString        InSlotName,
+		                     int32          InUserIndex);
+		~FSaveGameAwaiterBase();
+
+		constexpr bool await_ready() const noexcept
+		{
+			return false;
+		}
+
+	protected:
+		// ワーカーでの処理を開始する
+		// 開始出来なかった場合はfalseを返す
+		bool Start(std::coroutine_handle<> coroutine, TUniqueFunction<void(FTaskState&)> Work);
+
+		FWeakObjectPtr                              WorldContext;
+		FString                                     SlotName;
+		int32                                       UserIndex;
+		TSharedPtr<FTaskState, ESPMode::ThreadSafe> State;
+
+	private:
+		// ゲームスレッドで呼ばれる完了通知
+		void OnCompleted();
+
+		TWeakObjectPtr<UUncoScheduler> Scheduler;
+	};
+
+	/**
+	 * @brief セーブデータの非同期保存待機
+	*/
+	struct UNREALCOROUTINE_API FSaveGameAwaiter : public FSaveGameAwaiterBase
+	{
+		FSaveGameAwaiter(const UObject* InWorldContext,
+		                 USaveGame*     InSaveGameObject,
+		                 FString        InSlotName,
+		                 int32          InUserIndex,
+		                 bool           bInCompress);
+
+		bool await_suspend(std::coroutine_handle<> coroutine);
+		// 保存に成功したか？
+		bool await_resume() const;
+
+	private:
+		TWeakObjectPtr<USaveGame> SaveGameObject;
+		bool                      bCompress;
+	};
+
+	/**
+	 * @brief セーブデータの非同期読み込み待機
+	*/
+	struct UNREALCOROUTINE_API FLoadGameAwaiterBase : public FSaveGameAwaiterBase
+	{
+		using FSaveGameAwaiterBase::FSaveGameAwaiterBase;
+
+		bool await_suspend(std::coroutine_handle<> coroutine);
+
+	protected:
+		// 読み込んだデータからセーブデータオブジェクトを生成する
+		USaveGame* Deserialize() const;
+	};
+
+	template<class T>
+	struct TLoadGameAwaiter : public FLoadGameAwaiterBase
+	{
+		using FLoadGameAwaiterBase::FLoadGameAwaiterBase;
+
+		[[nodiscard]] T* await_resume() const
+		{
+			return Cast<T>(Deserialize());
+		}
 	};
 
 } // namespace unco::details
@@ -50,4 +308,137 @@ namespace unco
 	UNREALCOROUTINE_API details::FGetGameModeAwaiter AsyncGetGameMode(
 	    const UObject* WorldContextObject);
 
+	/**
+	 * @brief アクターを複数フレームに分散してスポーンします
+	 *
+	 * クラスを非同期ロードした後、Budgetに収まる分だけ毎フレーム遅延スポーンを行います。
+	 * PreFinishSpawningを指定した場合はBeginPlayの前(FinishSpawningの前)に呼び出します。
+	 * @param WorldContextObject ワールドコンテキスト
+	 * @param ActorClass スポーンするアクタークラス
+	 * @param Transforms スポーンするトランスフォーム(この数だけスポーンします)
+	 * @param Budget 1フレームあたりの処理量
+	 * @param CollisionHandling スポーン時の衝突の扱い
+	 * @param Owner スポーンしたアクターのオーナー(省略可)
+	 * @param PreFinishSpawning スポーンしたアクターとTransforms上の位置を受け取る初期化処理(省略可)
+	 * @return スポーンされたアクター(Transformsと同じ順番、失敗した場合はnullptr)
+	 */
+	template<class T = AActor>
+	details::TSpawnActorsAwaiter<T> AsyncSpawnActors(
+	    const UObject*                     WorldContextObject,
+	    TSoftClassPtr<T>                   ActorClass,
+	    TArray<FTransform>                 Transforms,
+	    FFrameBudget                       Budget = FFrameBudget::Time(1.f),
+	    ESpawnActorCollisionHandlingMethod CollisionHandling =
+	        ESpawnActorCollisionHandlingMethod::AlwaysSpawn,
+	    AActor*                            Owner             = nullptr,
+	    TFunction<void(T*, int32)>         PreFinishSpawning = nullptr)
+	{
+		static_assert(std::is_base_of_v<AActor, T>, "AsyncSpawnActors requires an actor class");
+		details::FSpawnActorsAwaiterBase::FPreFinishSpawning PreFinish;
+		if ( PreFinishSpawning )
+		{
+			PreFinish = [PreFinishSpawning = MoveTemp(PreFinishSpawning)](AActor* Actor, int32 Index)
+			{
+				PreFinishSpawning(Cast<T>(Actor), Index);
+			};
+		}
+		return details::TSpawnActorsAwaiter<T>(WorldContextObject,
+		                                       ActorClass.ToSoftObjectPath(),
+		                                       MoveTemp(Transforms),
+		                                       Budget,
+		                                       CollisionHandling,
+		                                       Owner,
+		                                       MoveTemp(PreFinish));
+	}
+
+	/**
+	 * @brief ストリーミングレベルを非同期で読み込みます
+	 * @param WorldContextObject ワールドコンテキスト
+	 * @param LevelName 読み込むレベル名
+	 * @param bMakeVisible 読み込み後に表示するか(trueの場合は表示されるまで待機します)
+	 * @param bShouldBlockOnLoad ブロッキングロードを行うか
+	 * @param Progress 進捗の出力先(省略可)
+	 */
+	UNREALCOROUTINE_API details::FStreamLevelAwaiter AsyncLoadStreamLevel(
+	    const UObject*  WorldContextObject,
+	    FName           LevelName,
+	    bool            bMakeVisible,
+	    bool            bShouldBlockOnLoad = false,
+	    FAsyncProgress* Progress           = nullptr);
+
+	/**
+	 * @brief 複数のストリーミングレベルを非同期で読み込みます
+	 * 全てのレベルの読み込みが完了した時点で再開します
+	 * @param WorldContextObject ワールドコンテキスト
+	 * @param LevelNames 読み込むレベル名
+	 * @param bMakeVisible 読み込み後に表示するか(trueの場合は表示されるまで待機します)
+	 * @param bShouldBlockOnLoad ブロッキングロードを行うか
+	 * @param Progress 進捗の出力先(省略可)
+	 */
+	UNREALCOROUTINE_API details::FStreamLevelAwaiter AsyncLoadStreamLevels(
+	    const UObject*  WorldContextObject,
+	    TArray<FName>   LevelNames,
+	    bool            bMakeVisible,
+	    bool            bShouldBlockOnLoad = false,
+	    FAsyncProgress* Progress           = nullptr);
+
+	/**
+	 * @brief ストリーミングレベルを非同期で破棄します
+	 * @param WorldContextObject ワールドコンテキスト
+	 * @param LevelName 破棄するレベル名
+	 * @param bShouldBlockOnUnload ブロッキングで破棄を行うか
+	 */
+	UNREALCOROUTINE_API details::FStreamLevelAwaiter AsyncUnloadStreamLevel(
+	    const UObject* WorldContextObject,
+	    FName          LevelName,
+	    bool           bShouldBlockOnUnload = false);
+
+	/**
+	 * @brief 複数のストリーミングレベルを非同期で破棄します
+	 * 全てのレベルの破棄が完了した時点で再開します
+	 * @param WorldContextObject ワールドコンテキスト
+	 * @param LevelNames 破棄するレベル名
+	 * @param bShouldBlockOnUnload ブロッキングで破棄を行うか
+	 */
+	UNREALCOROUTINE_API details::FStreamLevelAwaiter AsyncUnloadStreamLevels(
+	    const UObject* WorldContextObject,
+	    TArray<FName>  LevelNames,
+	    bool           bShouldBlockOnUnload = false);
+
+	/**
+	 * @brief セーブデータを非同期で保存します
+	 *
+	 * オブジェクトのシリアライズはゲームスレッドで行い、圧縮とディスクへの書き込みはワーカースレッドで行います。
+	 * 圧縮しない場合はUGameplayStatics::LoadGameFromSlotでも読み込める形式で保存されます。
+	 * @param WorldContextObject ワールドコンテキスト
+	 * @param SaveGameObject 保存するセーブデータ
+	 * @param SlotName スロット名
+	 * @param UserIndex ユーザーインデックス
+	 * @param bCompress 圧縮するか
+	 * @return 保存に成功したか
+	 */
+	UNREALCOROUTINE_API details::FSaveGameAwaiter AsyncSaveGame(const UObject* WorldContextObject,
+	                                                            USaveGame*     SaveGameObject,
+	                                                            const FString& SlotName,
+	                                                            int32          UserIndex,
+	                                                            bool           bCompress = false);
+
+	/**
+	 * @brief セーブデータを非同期で読み込みます
+	 *
+	 * ディスクからの読み込みと展開はワーカースレッドで行い、オブジェクトの生成はゲームスレッドで行います。
+	 * @param WorldContextObject ワールドコンテキスト
+	 * @param SlotName スロット名
+	 * @param UserIndex ユーザーインデックス
+	 * @return 読み込んだセーブデータ(失敗した場合はnullptr)
+	 */
+	template<class T = USaveGame>
+	details::TLoadGameAwaiter<T> AsyncLoadGame(const UObject* WorldContextObject,
+	                                           const FString& SlotName,
+	                                           int32          UserIndex)
+	{
+		static_assert(std::is_base_of_v<USaveGame, T>, "AsyncLoadGame requires a USaveGame class");
+		return details::TLoadGameAwaiter<T>(WorldContextObject, SlotName, UserIndex);
+	}
+
 } // namespace unco
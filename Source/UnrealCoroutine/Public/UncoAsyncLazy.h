@@ -0,0 +1,359 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+// 1度だけ計算して共有する非同期の値を記述する
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UncoWaitList.h"
+#include <coroutine>
+#include <utility>
+
+namespace unco
+{
+	template<class T>
+	class TAsyncLazy;
+
+	/**
+	 * @brief TAsyncLazyの値を設定するハンドル
+	 *
+	 * 生成処理のコルーチンに引数として渡し、値が求まったらSetValueを呼ぶ。
+	 * 値を設定せずに破棄された場合(ホストの破棄でコルーチンが破棄された場合など)は生成を中断したものとして扱う。
+	 */
+	template<class T>
+	class TAsyncLazySetter
+	{
+	public:
+		TAsyncLazySetter() = default;
+		~TAsyncLazySetter()
+		{
+			if ( TAsyncLazy<T>* Owner = std::exchange(Lazy, nullptr) )
+			{
+				Owner->OnProducerAborted();
+			}
+		}
+
+		// コピー禁止
+		TAsyncLazySetter(const TAsyncLazySetter&) = delete;
+		void operator=(const TAsyncLazySetter&) = delete;
+
+		// ムーブ時はTAsyncLazy側の参照も付け替える
+		TAsyncLazySetter(TAsyncLazySetter&& Other) noexcept
+		    : Lazy(std::exchange(Other.Lazy, nullptr))
+		{
+			if ( Lazy != nullptr )
+			{
+				Lazy->Setter = this;
+			}
+		}
+		TAsyncLazySetter& operator=(TAsyncLazySetter&& Other) noexcept
+		{
+			if ( this != &Other )
+			{
+				if ( TAsyncLazy<T>* Owner = std::exchange(Lazy, nullptr) )
+				{
+					Owner->OnProducerAborted();
+				}
+				Lazy = std::exchange(Other.Lazy, nullptr);
+				if ( Lazy != nullptr )
+				{
+					Lazy->Setter = this;
+				}
+			}
+			return *this;
+		}
+
+		/**
+		 * @brief 値を設定して待機している全てのコルーチンを再開する
+		 *
+		 * 無効化された後の生成結果は破棄される。
+		 */
+		void SetValue(T InValue)
+		{
+			if ( TAsyncLazy<T>* Owner = std::exchange(Lazy, nullptr) )
+			{
+				Owner->OnProduced(MoveTemp(InValue));
+			}
+		}
+
+		// 値を設定する先が残っているか？
+		bool IsValid() const
+		{
+			return Lazy != nullptr;
+		}
+
+	private:
+		friend class TAsyncLazy<T>;
+
+		explicit TAsyncLazySetter(TAsyncLazy<T>& InLazy)
+		    : Lazy(&InLazy)
+		{
+			InLazy.Setter = this;
+		}
+
+		TAsyncLazy<T>* Lazy = nullptr;
+	};
+
+	namespace details
+	{
+		/**
+		 * @brief TAsyncLazyの待機ノード
+		 *
+		 * 再開前に値をコピーしておく為、再開したコルーチンがTAsyncLazyを破棄・無効化しても
+		 * 後続の待機者は自身の値を受け取れる。
+		*/
+		template<class T>
+		struct TAsyncLazyWaitNode : public FCoroutineWaitNode
+		{
+			T Result = T();
+		};
+
+		/**
+		 * @brief TAsyncLazyの値の待機
+		*/
+		template<class T>
+		struct TAsyncLazyAwaiter : private TAsyncLazyWaitNode<T>
+		{
+			explicit TAsyncLazyAwaiter(TAsyncLazy<T>& InLazy)
+			    : Lazy(InLazy)
+			{
+			}
+
+			bool await_ready()
+			{
+				if ( !Lazy.StartIfNeeded() )
+				{
+					return false;
+				}
+				this->Result = Lazy.Value;
+				return true;
+			}
+			void await_suspend(std::coroutine_handle<> coroutine)
+			{
+				this->Coroutine = coroutine;
+				Lazy.Waiters.PushBack(*this);
+			}
+			// 再開後はTAsyncLazyに触れない
+			[[nodiscard]] T await_resume()
+			{
+				return MoveTemp(this->Result);
+			}
+
+		private:
+			TAsyncLazy<T>& Lazy;
+		};
+	} // namespace details
+
+	/**
+	 * @brief 最初のco_awaitで1度だけ計算し、以降は共有する非同期の値
+	 *
+	 * 最初にGetをco_awaitした時に生成処理を開始し、計算中にGetしたコルーチンは同じ計算の完了を待つ。
+	 * 完了後のGetは待機せずにキャッシュした値を返す。
+	 * 生成処理が値を設定せずに終了した場合、待機していたコルーチンは既定値で再開され、次のGetで生成をやり直す。
+	 * ホストを指定した場合はホストが破棄された時点でキャッシュを捨て、以降は生成せずに既定値を返す。
+	 * ゲームスレッドからのみ使用する。待機中のコルーチンはTAsyncLazyが破棄されると再開されない。
+	 *
+	 * @code
+	 * unco::TAsyncLazy<UDataTable*> ConfigTable(this, [this](unco::TAsyncLazySetter<UDataTable*> Setter) {
+	 *     LoadConfigTable(MoveTemp(Setter));
+	 * });
+	 *
+	 * unco::FObjectTask AMyActor::LoadConfigTable(unco::TAsyncLazySetter<UDataTable*> Setter)
+	 * {
+	 *     Setter.SetValue(co_await unco::AsyncLoadAsset(this, ConfigTablePath));
+	 * }
+	 *
+	 * // 何体のアクターから呼ばれても読み込みは1度だけ
+	 * UDataTable* Table = co_await ConfigTable.Get();
+	 * @endcode
+	 * @tparam T 値の型(デフォルトコンストラクト・コピー可能である事。待機者毎にコピーして返す)
+	 */
+	template<class T>
+	class TAsyncLazy
+	{
+	public:
+		/**
+		 * 生成処理
+		 * 渡されたハンドルで値を設定する。コルーチンを開始してハンドルを引数で渡す事を想定している。
+		 */
+		using FProducer = TUniqueFunction<void(TAsyncLazySetter<T> Setter)>;
+
+		/**
+		 * @param InProducer 生成処理
+		 */
+		explicit TAsyncLazy(FProducer InProducer)
+		    : Producer(MoveTemp(InProducer))
+		{
+		}
+
+		/**
+		 * @param InHost 値の寿命を決めるオブジェクト
+		 * @param InProducer 生成処理
+		 */
+		TAsyncLazy(const UObject* InHost, FProducer InProducer)
+		    : Producer(MoveTemp(InProducer))
+		    , Host(InHost)
+		    , bHasHost(true)
+		{
+		}
+
+		~TAsyncLazy()
+		{
+			DetachSetter();
+			// 待機者は切り離す
+			Waiters.Reset();
+		}
+
+		// コピー禁止+ムーブ禁止
+		// 待機ノードと生成中のハンドルがアドレスを保持する為
+		TAsyncLazy(const TAsyncLazy&) = delete;
+		TAsyncLazy(TAsyncLazy&&)      = delete;
+		void operator=(const TAsyncLazy&) = delete;
+		void operator=(TAsyncLazy&&) = delete;
+
+		/**
+		 * @brief 値を取得する
+		 *
+		 * 計算済みの場合は待機しない。
+		 * 値はコピーして返すので、TAsyncLazyの無効化・破棄の影響を受けない。
+		 */
+		[[nodiscard]] details::TAsyncLazyAwaiter<T> Get()
+		{
+			return details::TAsyncLazyAwaiter<T>(*this);
+		}
+
+		/**
+		 * @brief キャッシュした値を捨てる
+		 *
+		 * 計算中の場合はその結果を使用せず、待機しているコルーチンがあればすぐに計算をやり直す。
+		 */
+		void Invalidate()
+		{
+			check(IsInGameThread());
+
+			DetachSetter();
+			Value = T();
+			State = EState::Empty;
+
+			if ( !Waiters.IsEmpty() )
+			{
+				Start();
+			}
+		}
+
+		// 計算済みか？
+		bool IsReady() const
+		{
+			return State == EState::Ready;
+		}
+
+		// 計算中か？
+		bool IsRunning() const
+		{
+			return State == EState::Running;
+		}
+
+		// 計算済みの場合は値を返す
+		const T* TryGet() const
+		{
+			return IsReady() ? &Value : nullptr;
+		}
+
+	private:
+		friend class TAsyncLazySetter<T>;
+		friend struct details::TAsyncLazyAwaiter<T>;
+
+		enum class EState : uint8
+		{
+			// 未計算
+			Empty,
+			// 計算中
+			Running,
+			// 計算済み
+			Ready,
+		};
+
+		// 必要であれば計算を開始する
+		// 待機せずに値を返せる場合はtrueを返す
+		bool StartIfNeeded()
+		{
+			check(IsInGameThread());
+
+			// ホストが破棄された場合は生成しない
+			if ( bHasHost && !Host.IsValid() )
+			{
+				if ( State == EState::Ready )
+				{
+					Value = T();
+					State = EState::Empty;
+				}
+				return State != EState::Running;
+			}
+
+			if ( State == EState::Empty )
+			{
+				Start();
+			}
+			// 生成処理の中で完了・中断した場合も待機しない
+			return State != EState::Running;
+		}
+
+		void Start()
+		{
+			State = EState::Running;
+			Producer(TAsyncLazySetter<T>(*this));
+		}
+
+		void OnProduced(T&& InValue)
+		{
+			Setter = nullptr;
+			Value  = MoveTemp(InValue);
+			State  = EState::Ready;
+
+			ResumeWaiters();
+		}
+
+		void OnProducerAborted()
+		{
+			Setter = nullptr;
+			Value  = T();
+			State  = EState::Empty;
+
+			ResumeWaiters();
+		}
+
+		// 待機者に値を配ってから再開する
+		// 再開先でTAsyncLazyが破棄・無効化される可能性がある為、再開前に全ての待機者へ値をコピーし
+		// 再開中はメンバーに触れない
+		void ResumeWaiters()
+		{
+			details::TWaitList<details::TAsyncLazyWaitNode<T>> Pending;
+			while ( details::TAsyncLazyWaitNode<T>* Node = Waiters.PopFront() )
+			{
+				Node->Result = Value;
+				Pending.PushBack(*Node);
+			}
+			while ( details::TAsyncLazyWaitNode<T>* Node = Pending.PopFront() )
+			{
+				Node->Coroutine.resume();
+			}
+		}
+
+		// 計算中のハンドルを切り離して結果を受け取らない様にする
+		void DetachSetter()
+		{
+			if ( Setter != nullptr )
+			{
+				Setter->Lazy = nullptr;
+				Setter       = nullptr;
+			}
+		}
+
+		FProducer                                          Producer;
+		T                                                  Value = T();
+		details::TWaitList<details::TAsyncLazyWaitNode<T>> Waiters;
+		TAsyncLazySetter<T>*                               Setter = nullptr;
+		FWeakObjectPtr                                     Host;
+		EState                                             State    = EState::Empty;
+		bool                                               bHasHost = false;
+	};
+
+} // namespace unco
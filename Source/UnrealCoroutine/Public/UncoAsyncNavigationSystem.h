@@ -0,0 +1,106 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+// UNavigationSystemV1の非同期関数を記述する
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if UNCO_WITH_NAVIGATION
+
+	#include "AI/Navigation/NavigationTypes.h"
+	#include "NavigationSystemTypes.h"
+	#include "UncoScheduler.h"
+	#include <coroutine>
+
+class UObject;
+class UNavigationSystemV1;
+
+namespace unco
+{
+
+	/**
+	 * @brief 非同期経路探索の結果
+	 */
+	struct FFindPathResult
+	{
+		ENavigationQueryResult::Type Result = ENavigationQueryResult::Invalid;
+		FNavPathSharedPtr            Path;
+
+		bool IsSuccessful() const
+		{
+			return Result == ENavigationQueryResult::Success && Path.IsValid();
+		}
+	};
+
+} // namespace unco
+
+namespace unco::details
+{
+
+	/**
+	 * @brief 非同期経路探索待機オブジェクト
+	 *
+	 * ナビゲーションのワーカーで探索が完了した時点でスケジューラーの再開キュー経由で再開する。
+	 * 待機中に破棄された場合(キャンセル・呼び出し元の破棄)は探索を中断する。
+	 * 探索の完了時にワールドコンテキストが破棄されている場合は再開しない。
+	*/
+	struct UNREALCOROUTINE_API FFindPathAwaiter : private FCoroutineWaitNode
+	{
+		FFindPathAwaiter(const UObject*             InWorldContext,
+		                 const FPathFindingQuery&   InQuery,
+		                 const FNavAgentProperties& InAgentProperties,
+		                 EPathFindingMode::Type     InMode);
+		~FFindPathAwaiter();
+
+		constexpr bool await_ready() const noexcept
+		{
+			return false;
+		}
+		// 探索を開始出来なかった場合は中断せずに失敗を返す
+		bool await_suspend(std::coroutine_handle<> coroutine);
+
+		[[nodiscard]] FFindPathResult await_resume()
+		{
+			return MoveTemp(Result);
+		}
+
+	private:
+		static void OnPathFound(uint32                       InQueryID,
+		                        ENavigationQueryResult::Type InResult,
+		                        FNavPathSharedPtr            InPath);
+
+		FWeakObjectPtr                      WorldContext;
+		FPathFindingQuery                   Query;
+		FNavAgentProperties                 AgentProperties;
+		EPathFindingMode::Type              Mode;
+		TWeakObjectPtr<UNavigationSystemV1> NavSys;
+		TWeakObjectPtr<UUncoScheduler>      Scheduler;
+		uint32                              QueryID = INVALID_NAVQUERYID;
+		FFindPathResult                     Result;
+	};
+
+} // namespace unco::details
+
+namespace unco
+{
+
+	/**
+	 * @brief 非同期で経路探索を行います
+	 *
+	 * UNavigationSystemV1::FindPathAsyncをラップし、探索完了時に再開します。
+	 * 待機中にコルーチンが破棄された場合は探索を中断します。
+	 * 探索の完了時にワールドコンテキストが破棄されている場合は再開せず、コルーチンはホストと共に破棄されます。
+	 * @param WorldContextObject ワールドコンテキスト
+	 * @param Query 経路探索クエリ
+	 * @param AgentProperties QueryにNavDataが設定されていない場合にNavDataを選択する為のエージェント情報
+	 * @param Mode 探索モード
+	 * @return 探索結果
+	 */
+	UNREALCOROUTINE_API details::FFindPathAwaiter AsyncFindPath(
+	    const UObject*             WorldContextObject,
+	    const FPathFindingQuery&   Query,
+	    const FNavAgentProperties& AgentProperties = FNavAgentProperties::DefaultProperties,
+	    EPathFindingMode::Type     Mode            = EPathFindingMode::Regular);
+
+} // namespace unco
+
+#endif // UNCO_WITH_NAVIGATION
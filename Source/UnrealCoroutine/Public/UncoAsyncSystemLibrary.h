@@ -6,25 +6,45 @@
 
 #include "CoreMinimal.h"
 #include "Engine/EngineTypes.h"
+#include "UncoScheduler.h"
 class UObject;
+class UWorld;
+struct FStreamableHandle;
 
 namespace unco::details
 {
 
-	struct UNREALCOROUTINE_API FLoadAssetAwaiterBase
+	/**
+	 * @brief プラグイン共通のFStreamableManagerで非同期ロードをリクエストする
+	 * @param Asset ロードするアセット
+	 * @return ストリーミングハンドル
+	*/
+	UNREALCOROUTINE_API TSharedPtr<FStreamableHandle> RequestAsyncLoad(
+	    const FSoftObjectPath& Asset);
+
+	/**
+	 * @brief アセット読み込み待機の基底
+	 *
+	 * 読み込みの完了はスケジューラーのTickで確認する。
+	*/
+	struct UNREALCOROUTINE_API FLoadAssetAwaiterBase : private FTickWaitNode
 	{
 		FLoadAssetAwaiterBase(const UObject*  InWorldContext,
 		                      FSoftObjectPath InAsset);
-		virtual ~FLoadAssetAwaiterBase();
+		~FLoadAssetAwaiterBase();
 		bool await_ready() const noexcept;
-		void await_suspend(std::coroutine_handle<> coroutine);
+		// スケジューラーが無い場合は中断せずにnullptrを返す
+		bool await_suspend(std::coroutine_handle<> coroutine);
 
 	protected:
-		class FDelayAction;
 		FWeakObjectPtr  WorldContext;
 		FSoftObjectPath Asset;
 		UObject*        ResultObject = nullptr;
-		FDelayAction*   Action       = nullptr;
+
+	private:
+		static bool OnTickLoad(FTickWaitNode& Node, float DeltaTime);
+
+		TSharedPtr<FStreamableHandle> Handle;
 	};
 
 	/**
@@ -62,60 +82,59 @@ namespace unco::details
 	/**
 	 * @brief 遅延待機
 	*/
-	struct UNREALCOROUTINE_API FDelayAwaiter
+	struct UNREALCOROUTINE_API FDelayAwaiter : private FTickWaitNode
 	{
 
-		FDelayAwaiter(UObject* InWorldContext, float InDuration);
-		~FDelayAwaiter();
+		FDelayAwaiter(UObject* InWorldContext, float InDuration, float InLatenessTolerance = 0.f);
 		bool           await_ready() const noexcept;
-		void           await_suspend(std::coroutine_handle<> coroutine);
+		bool           await_suspend(std::coroutine_handle<> coroutine);
 		constexpr void await_resume() const noexcept {}
 
 	private:
-		class FDelayAction;
-		FWeakObjectPtr      WorldContext;
-		FTimerHandle        TimerHandle;
-		float               Duration;
-		class FDelayAction* Action = nullptr;
+		static bool OnTickDelay(FTickWaitNode& Node, float DeltaTime);
+
+		FWeakObjectPtr WorldContext;
+		float          TimeRemaining;
 	};
 
-	struct UNREALCOROUTINE_API FDelayUntilNextTickAwaiter
+	struct UNREALCOROUTINE_API FDelayUntilNextTickAwaiter : private FTickWaitNode
 	{
 
 		FDelayUntilNextTickAwaiter(UObject* InWorldContext);
-		~FDelayUntilNextTickAwaiter();
 		constexpr bool await_ready() const noexcept
 		{
 			return false;
 		}
-		void           await_suspend(std::coroutine_handle<> coroutine);
+		bool           await_suspend(std::coroutine_handle<> coroutine);
 		constexpr void await_resume() const noexcept {}
 
 	private:
-		class FDelayAction;
+		static bool OnTickNextFrame(FTickWaitNode& Node, float DeltaTime);
+
 		FWeakObjectPtr WorldContext;
-		FTimerHandle   TimerHandle;
-		FDelayAction*  Action = nullptr;
+		uint64         SuspendFrame = 0;
 	};
 
-	struct UNREALCOROUTINE_API FTimerAwaiter
+	struct UNREALCOROUTINE_API FTimerAwaiter : private FTickWaitNode
 	{
 
 		FTimerAwaiter(UObject* InWorldContext,
 		              float    InTime,
 		              float    InitialStartDelay,
-		              float    InitialStartDelayVariance);
-		~FTimerAwaiter();
+		              float    InitialStartDelayVariance,
+		              float    InLatenessTolerance = 0.f);
 		bool           await_ready() const noexcept;
-		void           await_suspend(std::coroutine_handle<> coroutine);
+		bool           await_suspend(std::coroutine_handle<> coroutine);
 		constexpr void await_resume() noexcept {}
 
 	private:
+		static bool OnTickTimer(FTickWaitNode& Node, float DeltaTime);
+
 		TWeakObjectPtr<> WorldContext;
-		FTimerHandle     TimerHandle;
 		float            Time;
 		float            InitialStartDelay;
 		float            InitialStartDelayVariance;
+		float            TimeRemaining = 0.f;
 	};
 
 } // namespace unco::details
@@ -147,10 +166,12 @@ namespace unco
 	 *
 	 * @param WorldContext	ワールドコンテキスト
 	 * @param Duration 		待機時間(秒).
+	 * @param LatenessTolerance	再開が混み合っている場合に再開を遅らせて良い時間(秒)。UUncoScheduler::SetResumeQuotaを参照
 	 */
 	UNREALCOROUTINE_API unco::details::FDelayAwaiter AsyncDelay(
 	    UObject* WorldContext,
-	    float    Duration);
+	    float    Duration,
+	    float    LatenessTolerance = 0.f);
 
 	/**
 	 * 非同期で次のフレームまで待機します
@@ -167,11 +188,13 @@ namespace unco
 	 * @param InitialStartDelay タイマーマネージャーに渡される初期遅延（秒単位）。
 	 * @param InitialStartDelayVariance これを使用して、ランダムを実行する代わりにタイマーが開始するタイミングに分散を追加します
 	 * InitialStartDelay 入力の範囲（秒単位）。
+	 * @param LatenessTolerance 再開が混み合っている場合に再開を遅らせて良い時間(秒)。UUncoScheduler::SetResumeQuotaを参照
 	 */
 	UNREALCOROUTINE_API unco::details::FTimerAwaiter AsyncSetTimer(
 	    UObject* WorldContext,
 	    float    Time,
 	    float    InitialStartDelay         = 0.f,
-	    float    InitialStartDelayVariance = 0.f);
+	    float    InitialStartDelayVariance = 0.f,
+	    float    LatenessTolerance         = 0.f);
 
 } // namespace unco
\ No newline at end of file
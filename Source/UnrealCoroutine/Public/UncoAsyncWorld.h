@@ -0,0 +1,233 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+// UWorldの非同期関数を記述する
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CollisionQueryParams.h"
+#include "Engine/EngineTypes.h"
+#include "UncoScheduler.h"
+#include "WorldCollision.h"
+#include <coroutine>
+
+class UObject;
+
+namespace unco
+{
+
+	/**
+	 * @brief 非同期トレースのリクエスト
+	 */
+	struct FTraceRequest
+	{
+		FVector Start = FVector::ZeroVector;
+		FVector End   = FVector::ZeroVector;
+		// スイープ時の回転
+		FQuat Rot = FQuat::Identity;
+		// デフォルトはライントレース
+		FCollisionShape Shape;
+	};
+
+} // namespace unco
+
+namespace unco::details
+{
+
+	/**
+	 * @brief 非同期トレース待機の基底
+	 *
+	 * UWorldの非同期トレースキューに積み、トレースはフレーム中にワーカースレッドで実行される。
+	 * 結果が揃った次のフレームのスケジューラーのTickで再開する。
+	*/
+	struct UNREALCOROUTINE_API FAsyncTraceAwaiterBase : private FTickWaitNode
+	{
+		FAsyncTraceAwaiterBase(const UObject*                  InWorldContext,
+		                       TArray<FTraceRequest>           InRequests,
+		                       ECollisionChannel               InChannel,
+		                       const FCollisionQueryParams&    InParams,
+		                       const FCollisionResponseParams& InResponseParams,
+		                       EAsyncTraceType                 InTraceType);
+
+		constexpr bool await_ready() const noexcept
+		{
+			return false;
+		}
+		// ワールドが無効な場合は中断せずに空の結果を返す
+		bool await_suspend(std::coroutine_handle<> coroutine);
+
+	protected:
+		TArray<TArray<FHitResult>> Results;
+
+	private:
+		static bool OnTickTrace(FTickWaitNode& Node, float DeltaTime);
+
+		TWeakObjectPtr<UWorld>                 World;
+		TArray<FTraceRequest>                  Requests;
+		TArray<FTraceHandle, TInlineAllocator<1>> Handles;
+		FCollisionQueryParams                  Params;
+		FCollisionResponseParams               ResponseParams;
+		ECollisionChannel                      Channel;
+		EAsyncTraceType                        TraceType;
+		int32                                  NumPending = 0;
+	};
+
+	/**
+	 * @brief 非同期トレース待機
+	*/
+	struct FAsyncTraceAwaiter : public FAsyncTraceAwaiterBase
+	{
+		using FAsyncTraceAwaiterBase::FAsyncTraceAwaiterBase;
+
+		[[nodiscard]] TArray<FHitResult> await_resume()
+		{
+			return Results.Num() > 0 ? MoveTemp(Results[0]) : TArray<FHitResult>();
+		}
+	};
+
+	/**
+	 * @brief 複数の非同期トレース待機
+	*/
+	struct FAsyncTraceBatchAwaiter : public FAsyncTraceAwaiterBase
+	{
+		using FAsyncTraceAwaiterBase::FAsyncTraceAwaiterBase;
+
+		[[nodiscard]] TArray<TArray<FHitResult>> await_resume()
+		{
+			return MoveTemp(Results);
+		}
+	};
+
+	/**
+	 * @brief 非同期オーバーラップ待機
+	*/
+	struct UNREALCOROUTINE_API FAsyncOverlapAwaiter : private FTickWaitNode
+	{
+		FAsyncOverlapAwaiter(const UObject*                  InWorldContext,
+		                     const FVector&                  InPos,
+		                     const FQuat&                    InRot,
+		                     ECollisionChannel               InChannel,
+		                     const FCollisionShape&          InShape,
+		                     const FCollisionQueryParams&    InParams,
+		                     const FCollisionResponseParams& InResponseParams);
+
+		constexpr bool await_ready() const noexcept
+		{
+			return false;
+		}
+		// ワールドが無効な場合は中断せずに空の結果を返す
+		bool await_suspend(std::coroutine_handle<> coroutine);
+
+		[[nodiscard]] TArray<FOverlapResult> await_resume()
+		{
+			return MoveTemp(Result);
+		}
+
+	private:
+		static bool OnTickOverlap(FTickWaitNode& Node, float DeltaTime);
+
+		TWeakObjectPtr<UWorld>   World;
+		FVector                  Pos;
+		FQuat                    Rot;
+		FCollisionShape          Shape;
+		FCollisionQueryParams    Params;
+		FCollisionResponseParams ResponseParams;
+		ECollisionChannel        Channel;
+		FTraceHandle             Handle;
+		TArray<FOverlapResult>   Result;
+	};
+
+} // namespace unco::details
+
+namespace unco
+{
+
+	/**
+	 * @brief 非同期でライントレースを行います
+	 *
+	 * トレースはフレーム中にワーカースレッドで実行され、次のフレームで結果と共に再開します。
+	 * @param WorldContextObject ワールドコンテキスト
+	 * @param Start 開始位置
+	 * @param End 終了位置
+	 * @param Channel トレースチャンネル
+	 * @param Params クエリパラメーター
+	 * @param ResponseParams レスポンスパラメーター
+	 * @param TraceType Singleの場合は最初のブロッキングヒットのみ、Multiの場合は全てのヒット
+	 * @return ヒット結果
+	 */
+	UNREALCOROUTINE_API details::FAsyncTraceAwaiter AsyncLineTrace(
+	    const UObject*                  WorldContextObject,
+	    const FVector&                  Start,
+	    const FVector&                  End,
+	    ECollisionChannel               Channel,
+	    const FCollisionQueryParams&    Params = FCollisionQueryParams::DefaultQueryParam,
+	    const FCollisionResponseParams& ResponseParams =
+	        FCollisionResponseParams::DefaultResponseParam,
+	    EAsyncTraceType TraceType = EAsyncTraceType::Single);
+
+	/**
+	 * @brief 非同期でスイープを行います
+	 * @param WorldContextObject ワールドコンテキスト
+	 * @param Start 開始位置
+	 * @param End 終了位置
+	 * @param Rot 形状の回転
+	 * @param Channel トレースチャンネル
+	 * @param Shape スイープする形状
+	 * @param Params クエリパラメーター
+	 * @param ResponseParams レスポンスパラメーター
+	 * @param TraceType Singleの場合は最初のブロッキングヒットのみ、Multiの場合は全てのヒット
+	 * @return ヒット結果
+	 */
+	UNREALCOROUTINE_API details::FAsyncTraceAwaiter AsyncSweep(
+	    const UObject*                  WorldContextObject,
+	    const FVector&                  Start,
+	    const FVector&                  End,
+	    const FQuat&                    Rot,
+	    ECollisionChannel               Channel,
+	    const FCollisionShape&          Shape,
+	    const FCollisionQueryParams&    Params = FCollisionQueryParams::DefaultQueryParam,
+	    const FCollisionResponseParams& ResponseParams =
+	        FCollisionResponseParams::DefaultResponseParam,
+	    EAsyncTraceType TraceType = EAsyncTraceType::Single);
+
+	/**
+	 * @brief 非同期でオーバーラップを行います
+	 * @param WorldContextObject ワールドコンテキスト
+	 * @param Pos 位置
+	 * @param Rot 形状の回転
+	 * @param Channel トレースチャンネル
+	 * @param Shape 形状
+	 * @param Params クエリパラメーター
+	 * @param ResponseParams レスポンスパラメーター
+	 * @return オーバーラップ結果
+	 */
+	UNREALCOROUTINE_API details::FAsyncOverlapAwaiter AsyncOverlap(
+	    const UObject*                  WorldContextObject,
+	    const FVector&                  Pos,
+	    const FQuat&                    Rot,
+	    ECollisionChannel               Channel,
+	    const FCollisionShape&          Shape,
+	    const FCollisionQueryParams&    Params = FCollisionQueryParams::DefaultQueryParam,
+	    const FCollisionResponseParams& ResponseParams =
+	        FCollisionResponseParams::DefaultResponseParam);
+
+	/**
+	 * @brief 複数の非同期トレースをまとめて行います
+	 *
+	 * 全てのトレースの結果が揃った時点で1度だけ再開します。
+	 * @param WorldContextObject ワールドコンテキスト
+	 * @param Requests トレースのリクエスト(ShapeがLineの場合はライントレース)
+	 * @param Channel トレースチャンネル
+	 * @param Params クエリパラメーター
+	 * @param ResponseParams レスポンスパラメーター
+	 * @param TraceType Singleの場合は最初のブロッキングヒットのみ、Multiの場合は全てのヒット
+	 * @return Requestsと同じ順番のヒット結果
+	 */
+	UNREALCOROUTINE_API details::FAsyncTraceBatchAwaiter AsyncTraceBatch(
+	    const UObject*                  WorldContextObject,
+	    TArray<FTraceRequest>           Requests,
+	    ECollisionChannel               Channel,
+	    const FCollisionQueryParams&    Params = FCollisionQueryParams::DefaultQueryParam,
+	    const FCollisionResponseParams& ResponseParams =
+	        FCollisionResponseParams::DefaultResponseParam,
+	    EAsyncTraceType TraceType = EAsyncTraceType::Single);
+
+} // namespace unco
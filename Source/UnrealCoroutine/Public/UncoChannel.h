@@ -0,0 +1,438 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+// コルーチン・スレッド間で値を受け渡すチャンネルを記述する
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Async.h"
+#include "HAL/CriticalSection.h"
+#include "Misc/ScopeLock.h"
+#include "Templates/SharedPointer.h"
+#include "UncoWaitList.h"
+#include <atomic>
+#include <coroutine>
+
+namespace unco::details
+{
+
+	/**
+	 * @brief 送信待機ノード
+	 *
+	 * バッファが満杯の間、送信する値を保持する。
+	*/
+	template<class T>
+	struct TChannelSendNode : public FCoroutineWaitNode
+	{
+		explicit TChannelSendNode(T&& InValue)
+		    : Value(MoveTemp(InValue))
+		{
+		}
+
+		T    Value;
+		bool bSent = false;
+	};
+
+	/**
+	 * @brief 受信待機ノード
+	 *
+	 * 値が届いた時点で直接受け渡される。
+	*/
+	template<class T>
+	struct TChannelReceiveNode : public FCoroutineWaitNode
+	{
+		TOptional<T> Value;
+	};
+
+	/**
+	 * @brief チャンネルの共有状態
+	 *
+	 * リングバッファとクローズ状態はロックで保護され、任意のスレッドから操作出来る。
+	 * 待機リストはゲームスレッドからのみ操作され、待機しているコルーチンはゲームスレッドで再開する。
+	 * ワーカースレッドからの操作で待機を解除する必要がある場合はゲームスレッドにタスクを投げる。
+	*/
+	template<class T>
+	class TChannelState : public TSharedFromThis<TChannelState<T>, ESPMode::ThreadSafe>
+	{
+	public:
+		explicit TChannelState(int32 InCapacity)
+		{
+			Slots.SetNum(FMath::Max(InCapacity, 1));
+		}
+
+		bool TrySend(T& Value)
+		{
+			{
+				FScopeLock Lock(&CriticalSection);
+				if ( bClosed || Count >= Slots.Num() )
+				{
+					return false;
+				}
+				Push(MoveTemp(Value));
+			}
+			RequestPump();
+			return true;
+		}
+
+		TOptional<T> TryReceive()
+		{
+			TOptional<T> Result;
+			{
+				FScopeLock Lock(&CriticalSection);
+				if ( Count > 0 )
+				{
+					Result.Emplace(Pop());
+				}
+			}
+			if ( Result.IsSet() )
+			{
+				RequestPump();
+			}
+			return Result;
+		}
+
+		void Close()
+		{
+			{
+				FScopeLock Lock(&CriticalSection);
+				if ( bClosed )
+				{
+					return;
+				}
+				bClosed = true;
+			}
+			RequestPump();
+		}
+
+		bool IsClosed() const
+		{
+			FScopeLock Lock(&CriticalSection);
+			return bClosed;
+		}
+
+		int32 Num() const
+		{
+			FScopeLock Lock(&CriticalSection);
+			return Count;
+		}
+
+		int32 Capacity() const
+		{
+			return Slots.Num();
+		}
+
+		// 後から来た待機が先に処理されない様に、待機中のものがあれば即時完了させない
+		bool HasSenders() const
+		{
+			return !Senders.IsEmpty();
+		}
+		bool HasReceivers() const
+		{
+			return !Receivers.IsEmpty();
+		}
+
+		void AddSender(TChannelSendNode<T>& Node)
+		{
+			check(IsInGameThread());
+			Senders.PushBack(Node);
+		}
+		void AddReceiver(TChannelReceiveNode<T>& Node)
+		{
+			check(IsInGameThread());
+			Receivers.PushBack(Node);
+		}
+
+		/**
+		 * @brief 待機中の送信・受信をバッファと突き合わせて再開する
+		 *
+		 * ゲームスレッドからのみ呼ばれる。
+		 * 再開はロックを解放してからまとめて行う。
+		*/
+		void Pump()
+		{
+			check(IsInGameThread());
+
+			TWaitList<FCoroutineWaitNode> Resumed;
+			{
+				FScopeLock Lock(&CriticalSection);
+
+				bool bProgress = true;
+				while ( bProgress )
+				{
+					bProgress = false;
+
+					// 空いたスロットに待機中の値を移す
+					while ( !Senders.IsEmpty() && (bClosed || Count < Slots.Num()) )
+					{
+						TChannelSendNode<T>* Sender = Senders.PopFront();
+						if ( !bClosed )
+						{
+							Push(MoveTemp(Sender->Value));
+							Sender->bSent = true;
+						}
+						Resumed.PushBack(*Sender);
+					}
+
+					// 届いた値を待機中の受信側に直接渡す
+					while ( !Receivers.IsEmpty() && (bClosed || Count > 0) )
+					{
+						TChannelReceiveNode<T>* Receiver = Receivers.PopFront();
+						if ( Count > 0 )
+						{
+							Receiver->Value.Emplace(Pop());
+							// スロットが空いたので送信側をもう一度確認する
+							bProgress = true;
+						}
+						Resumed.PushBack(*Receiver);
+					}
+				}
+			}
+			ResumeAll(Resumed);
+		}
+
+	private:
+		void Push(T&& Value)
+		{
+			Slots[(Head + Count) % Slots.Num()].Emplace(MoveTemp(Value));
+			++Count;
+		}
+
+		T Pop()
+		{
+			TOptional<T>& Slot  = Slots[Head];
+			T             Value = MoveTemp(Slot.GetValue());
+			Slot.Reset();
+			Head = (Head + 1) % Slots.Num();
+			--Count;
+			return Value;
+		}
+
+		void RequestPump()
+		{
+			if ( IsInGameThread() )
+			{
+				if ( !Senders.IsEmpty() || !Receivers.IsEmpty() )
+				{
+					Pump();
+				}
+				return;
+			}
+
+			// ワーカースレッドからは待機リストに触れないのでゲームスレッドで処理する
+			// 既に投げている場合はまとめる
+			if ( bPumpPosted.exchange(true) )
+			{
+				return;
+			}
+			AsyncTask(ENamedThreads::GameThread,
+			          [WeakState = TWeakPtr<TChannelState, ESPMode::ThreadSafe>(this->AsShared())]()
+			          {
+				          if ( TSharedPtr<TChannelState, ESPMode::ThreadSafe> State = WeakState.Pin() )
+				          {
+					          State->bPumpPosted = false;
+					          State->Pump();
+				          }
+			          });
+		}
+
+		mutable FCriticalSection          CriticalSection;
+		TArray<TOptional<T>>              Slots;
+		int32                             Head    = 0;
+		int32                             Count   = 0;
+		bool                              bClosed = false;
+		std::atomic<bool>                 bPumpPosted{false};
+		TWaitList<TChannelSendNode<T>>    Senders;
+		TWaitList<TChannelReceiveNode<T>> Receivers;
+	};
+
+	/**
+	 * @brief チャンネルへの送信待機
+	*/
+	template<class T>
+	struct TChannelSendAwaiter
+	{
+		TChannelSendAwaiter(TChannelState<T>& InState, T&& InValue)
+		    : State(InState)
+		    , Node(MoveTemp(InValue))
+		{
+		}
+
+		bool await_ready()
+		{
+			if ( State.HasSenders() )
+			{
+				return State.IsClosed();
+			}
+			Node.bSent = State.TrySend(Node.Value);
+			return Node.bSent || State.IsClosed();
+		}
+		void await_suspend(std::coroutine_handle<> coroutine)
+		{
+			Node.Coroutine = coroutine;
+			State.AddSender(Node);
+		}
+		// 送信出来たか？(クローズされていた場合はfalse)
+		bool await_resume() const noexcept
+		{
+			return Node.bSent;
+		}
+
+	private:
+		TChannelState<T>&   State;
+		TChannelSendNode<T> Node;
+	};
+
+	/**
+	 * @brief チャンネルからの受信待機
+	*/
+	template<class T>
+	struct TChannelReceiveAwaiter
+	{
+		explicit TChannelReceiveAwaiter(TChannelState<T>& InState)
+		    : State(InState)
+		{
+		}
+
+		bool await_ready()
+		{
+			if ( State.HasReceivers() )
+			{
+				return false;
+			}
+			Node.Value = State.TryReceive();
+			return Node.Value.IsSet() || State.IsClosed();
+		}
+		void await_suspend(std::coroutine_handle<> coroutine)
+		{
+			Node.Coroutine = coroutine;
+			State.AddReceiver(Node);
+		}
+		// クローズされて空になった場合は値を持たない
+		[[nodiscard]] TOptional<T> await_resume()
+		{
+			return MoveTemp(Node.Value);
+		}
+
+	private:
+		TChannelState<T>&      State;
+		TChannelReceiveNode<T> Node;
+	};
+
+} // namespace unco::details
+
+namespace unco
+{
+
+	/**
+	 * @brief 容量制限付きのチャンネル
+	 *
+	 * コルーチン間・スレッド間で値をムーブで受け渡す。
+	 * バッファが満杯の場合はSendが、空の場合はReceiveが待機する。
+	 * co_awaitはゲームスレッドのコルーチンから行い、ワーカースレッドからはTrySend・TryReceiveを使用する。
+	 * 待機しているコルーチンはチャンネルが破棄されると再開されないので、チャンネルより先に破棄する事。
+	 *
+	 * @code
+	 * unco::TChannel<FDecodedChunk> Channel(8);
+	 *
+	 * // 生産側(ワーカースレッド)
+	 * if ( !Channel.TrySend(MoveTemp(Chunk)) ) { ... }
+	 *
+	 * // 消費側(ゲームスレッドのコルーチン)
+	 * while ( TOptional<FDecodedChunk> Chunk = co_await Channel.Receive() )
+	 * {
+	 *     Apply(*Chunk);
+	 * }
+	 * @endcode
+	 */
+	template<class T>
+	class TChannel
+	{
+	public:
+		/**
+		 * @param Capacity バッファに保持出来る値の数(1以上)
+		 */
+		explicit TChannel(int32 Capacity)
+		    : State(MakeShared<details::TChannelState<T>, ESPMode::ThreadSafe>(Capacity))
+		{
+		}
+
+		// コピー禁止+ムーブ禁止
+		// Awaiterが共有状態を参照する為
+		TChannel(const TChannel&) = delete;
+		TChannel(TChannel&&)      = delete;
+		void operator=(const TChannel&) = delete;
+		void operator=(TChannel&&) = delete;
+
+		/**
+		 * @brief 値を送信する
+		 *
+		 * バッファが満杯の場合は空くまで待機する。
+		 * @return 送信出来たか(クローズされていた場合はfalse)
+		 */
+		[[nodiscard]] details::TChannelSendAwaiter<T> Send(T Value)
+		{
+			return details::TChannelSendAwaiter<T>(*State, MoveTemp(Value));
+		}
+
+		/**
+		 * @brief 値を受信する
+		 *
+		 * バッファが空の場合は値が届くまで待機する。
+		 * @return 受信した値(クローズされて空の場合は値を持たない)
+		 */
+		[[nodiscard]] details::TChannelReceiveAwaiter<T> Receive()
+		{
+			return details::TChannelReceiveAwaiter<T>(*State);
+		}
+
+		/**
+		 * @brief 待機せずに送信する(スレッドセーフ)
+		 * @return 送信出来たか。失敗した場合Valueはそのまま残る
+		 */
+		bool TrySend(T&& Value)
+		{
+			return State->TrySend(Value);
+		}
+		bool TrySend(const T& Value)
+		{
+			T Copy(Value);
+			return State->TrySend(Copy);
+		}
+
+		/**
+		 * @brief 待機せずに受信する(スレッドセーフ)
+		 */
+		TOptional<T> TryReceive()
+		{
+			return State->TryReceive();
+		}
+
+		/**
+		 * @brief チャンネルを閉じる(スレッドセーフ)
+		 *
+		 * 待機中の送信は失敗として、受信はバッファが空になった時点で値無しとして再開する。
+		 */
+		void Close()
+		{
+			State->Close();
+		}
+
+		bool IsClosed() const
+		{
+			return State->IsClosed();
+		}
+
+		// バッファ内の値の数
+		int32 Num() const
+		{
+			return State->Num();
+		}
+
+		int32 Capacity() const
+		{
+			return State->Capacity();
+		}
+
+	private:
+		TSharedRef<details::TChannelState<T>, ESPMode::ThreadSafe> State;
+	};
+
+} // namespace unco
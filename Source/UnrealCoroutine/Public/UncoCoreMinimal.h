@@ -0,0 +1,19 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+// コルーチンの基盤が依存するエンジンのヘッダーを記述する
+#pragma once
+
+// エンジン外(Benchmark/のスタンドアロンのベンチマーク)でビルドするか？
+// 基盤のヘッダー(タスク・ジェネレーター・待機リスト・タスクの登録・分散フレーム実行)は
+// CoreMinimal.hの代わりにこのヘッダーを読み込み、エンジン無しでもビルド出来る様にする
+#ifndef UNCO_STANDALONE
+	#define UNCO_STANDALONE 0
+#endif
+
+#if UNCO_STANDALONE
+	// UObjectの生存判定・コンテナ・時計の最小限の代替
+	#include "UncoStandaloneShim.h"
+#else
+	#include "CoreMinimal.h"
+	#include "HAL/PlatformTime.h"
+	#include "UObject/WeakObjectPtr.h"
+#endif
@@ -0,0 +1,110 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+// 分散フレーム実行を記述する
+#pragma once
+
+#include "UncoCoreMinimal.h"
+#include "UncoFrameBudget.h"
+#include "UncoObjectGenerator.h"
+#include <utility>
+
+namespace unco
+{
+
+	struct FDistributedFrameInfo
+	{
+		FDistributedFrameInfo(FObjectGenerator&& InGenerator, const FFrameBudget& InBudget, bool bInCarryOver) noexcept
+		    : Generator(std::move(InGenerator))
+		    , Budget(InBudget)
+		    , bCarryOver(bInCarryOver)
+		{
+		}
+
+		FObjectGenerator Generator;
+		FFrameBudget     Budget;
+		// 使い切れなかった・超過したコストと使い切れなかった回数を次のフレームに持ち越すか？
+		bool bCarryOver = false;
+		// 持ち越したコスト(負の場合は前のフレームの超過分)
+		int32 CarriedCost = 0;
+		// 持ち越した回数
+		int32 CarriedCount = 0;
+	};
+
+	namespace details
+	{
+
+		/**
+		 * @brief ジェネレーターを1フレーム分進める
+		 *
+		 * 処理量に達するかジェネレーターが終了するまでMoveNextを繰り返す。
+		 * bCarryOverの場合は未使用分・超過分を次のフレームに持ち越す。
+		 * @param FrameInfo 分散フレーム実行の情報
+		 * @param Budget このフレームの処理量(重要度で調整したもの)
+		 * @return このフレームで進めたステップ数
+		*/
+		UNREALCOROUTINE_API int32 StepDistributedFrame(FDistributedFrameInfo& FrameInfo, const FFrameBudget& Budget);
+
+		/**
+		 * @brief 分散フレーム実行中のジェネレーターの一覧
+		 *
+		 * 実行中に追加されたものは実行の後に追加し、
+		 * 終了したもの・呼び出し元のオブジェクトが破棄されたものは実行の後に取り除く。
+		*/
+		class UNREALCOROUTINE_API FDistributedFrameList
+		{
+		public:
+			FDistributedFrameList() = default;
+
+			// コピー禁止+ムーブ禁止
+			// 実行中の一覧を入れ替えさせない為
+			FDistributedFrameList(const FDistributedFrameList&) = delete;
+			FDistributedFrameList(FDistributedFrameList&&)      = delete;
+			void operator=(const FDistributedFrameList&) = delete;
+			void operator=(FDistributedFrameList&&) = delete;
+
+			/**
+			 * @brief ジェネレーターを追加する
+			 * @param Generator 実行するコルーチン
+			 * @param Budget 1フレームの処理量
+			 * @param bCarryOver 回数・コストの未使用分とコストの超過分を次のフレームに持ち越すか
+			 */
+			void Add(FObjectGenerator&& Generator, const FFrameBudget& Budget, bool bCarryOver);
+
+			/**
+			 * @brief 全てのジェネレーターを1フレーム分実行する
+			 * @param RunEntry ジェネレーター毎に呼ばれる。通常はStepDistributedFrameを呼ぶ
+			 */
+			template<class FRunEntry>
+			void Run(FRunEntry&& RunEntry)
+			{
+				bRunning = true;
+				for ( FDistributedFrameInfo& FrameInfo : Entries )
+				{
+					RunEntry(FrameInfo);
+				}
+				Compact();
+
+				// フラグを無効化する
+				bRunning = false;
+			}
+
+			// 実行中のジェネレーター数
+			int32 Num() const
+			{
+				return Entries.Num();
+			}
+
+			// 全てのジェネレーターを破棄する
+			void Empty();
+
+		private:
+			// 終了したものを削除して実行中に追加されたものを追加する
+			void Compact();
+
+			TArray<FDistributedFrameInfo> Entries;
+			TArray<FDistributedFrameInfo> DelayedEntries;
+			bool                          bRunning = false;
+		};
+
+	} // namespace details
+
+} // namespace unco
@@ -0,0 +1,235 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+// イベントをまとめて処理する待機を記述する
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UncoScheduler.h"
+#include <coroutine>
+
+namespace unco
+{
+	template<class T>
+	class TEventQueue;
+
+	namespace details
+	{
+		/**
+		 * @brief イベントキューの型に依らない状態
+		*/
+		class FEventQueueBase
+		{
+		public:
+			// 溜まっているイベント数
+			int32 Num() const
+			{
+				return NumPending;
+			}
+
+			bool IsEmpty() const
+			{
+				return NumPending == 0;
+			}
+
+		protected:
+			friend struct FEventBatchAwaiterBase;
+
+			// これまでに追加されたイベント数
+			// 最後の追加からの経過時間の判定に使用する
+			uint64 PushCount = 0;
+			// 最後にまとめて取り出した時のスケジューラーの時刻(UUncoScheduler::GetTimeSeconds)
+			double LastBatchTime = TNumericLimits<double>::Lowest();
+			int32  NumPending    = 0;
+		};
+
+		/**
+		 * @brief イベントをまとめて取り出す待機の基底
+		 *
+		 * スケジューラーのTick毎に取り出す条件を判定する為、イベント毎の再開やタイマーは発生しない。
+		*/
+		struct UNREALCOROUTINE_API FEventBatchAwaiterBase : private FTickWaitNode
+		{
+			enum class EMode : uint8
+			{
+				// 毎フレーム
+				EveryFrame,
+				// 最後のイベントからInterval秒イベントが無かった時
+				Debounce,
+				// 前回取り出してからInterval秒以上経過している時
+				Throttle,
+			};
+
+			FEventBatchAwaiterBase(const UObject*   InWorldContext,
+			                       FEventQueueBase& InQueue,
+			                       EMode            InMode,
+			                       float            InInterval);
+
+			// イベントが溜まっていても次のTickまで待ってからまとめて取り出す
+			constexpr bool await_ready() const noexcept
+			{
+				return false;
+			}
+			// スケジューラーが無い場合は中断せずに溜まっているイベント(空の場合もある)を返す
+			bool await_suspend(std::coroutine_handle<> coroutine);
+
+		protected:
+			// イベントを取り出した事を記録する
+			void OnBatchTaken();
+
+		private:
+			static bool OnTickBatch(FTickWaitNode& Node, float DeltaTime);
+
+			FWeakObjectPtr   WorldContext;
+			FEventQueueBase& Queue;
+			// Throttleの時刻を取得するスケジューラー
+			TWeakObjectPtr<UUncoScheduler> Scheduler;
+			uint64           LastPushCount = 0;
+			float            Interval;
+			float            QuietTime = 0.f;
+			EMode            Mode;
+		};
+
+		/**
+		 * @brief イベントをまとめて取り出す待機
+		*/
+		template<class T>
+		struct TEventBatchAwaiter : public FEventBatchAwaiterBase
+		{
+			TEventBatchAwaiter(const UObject* InWorldContext, TEventQueue<T>& InQueue, EMode InMode, float InInterval)
+			    : FEventBatchAwaiterBase(InWorldContext, InQueue, InMode, InInterval)
+			    , Queue(InQueue)
+			{
+			}
+
+			[[nodiscard]] TArray<T> await_resume()
+			{
+				OnBatchTaken();
+				return Queue.Consume();
+			}
+
+		private:
+			TEventQueue<T>& Queue;
+		};
+	} // namespace details
+
+	/**
+	 * @brief まとめて処理するイベントのキュー
+	 *
+	 * イベントの発生時にPushし、処理するコルーチンはNextBatch等で溜まったイベントをまとめて受け取る。
+	 * 1フレームに大量のイベントが発生しても処理するコルーチンの再開は1度になる。
+	 * ゲームスレッドからのみ使用する。待機するコルーチンは1つを想定している。
+	 *
+	 * @code
+	 * // OnTakeAnyDamageからPushする
+	 * DamageEvents.Push(Damage);
+	 *
+	 * while ( true )
+	 * {
+	 *     TArray<float> Damages = co_await unco::NextBatch(this, DamageEvents);
+	 *     RecomputeHealthBar(Damages);
+	 * }
+	 * @endcode
+	 */
+	template<class T>
+	class TEventQueue : public details::FEventQueueBase
+	{
+	public:
+		TEventQueue() = default;
+
+		// コピー禁止+ムーブ禁止
+		// 待機中のAwaiterがアドレスを保持する為
+		TEventQueue(const TEventQueue&) = delete;
+		TEventQueue(TEventQueue&&)      = delete;
+		void operator=(const TEventQueue&) = delete;
+		void operator=(TEventQueue&&) = delete;
+
+		// イベントを追加する
+		void Push(const T& Event)
+		{
+			Emplace(Event);
+		}
+		void Push(T&& Event)
+		{
+			Emplace(MoveTemp(Event));
+		}
+
+		template<class... ArgTypes>
+		void Emplace(ArgTypes&&... Args)
+		{
+			check(IsInGameThread());
+			Events.Emplace(Forward<ArgTypes>(Args)...);
+			NumPending = Events.Num();
+			++PushCount;
+		}
+
+		// 溜まっているイベントを全て取り出す
+		[[nodiscard]] TArray<T> Consume()
+		{
+			NumPending = 0;
+			return MoveTemp(Events);
+		}
+
+		// 溜まっているイベントを捨てる
+		void Reset()
+		{
+			Events.Reset();
+			NumPending = 0;
+		}
+
+	private:
+		TArray<T> Events;
+	};
+
+	/**
+	 * @brief 前回の再開から溜まったイベントをまとめて受け取ります
+	 *
+	 * イベントが溜まっているフレームのスケジューラーのTickで1度だけ再開します。
+	 * スケジューラーが無い場合は中断せずに溜まっているイベント(空の場合もある)を返します。
+	 * @param WorldContextObject ワールドコンテキスト
+	 * @param Queue イベントキュー
+	 * @return 溜まったイベント(追加順)
+	 */
+	template<class T>
+	details::TEventBatchAwaiter<T> NextBatch(const UObject* WorldContextObject, TEventQueue<T>& Queue)
+	{
+		return details::TEventBatchAwaiter<T>(
+		    WorldContextObject, Queue, details::FEventBatchAwaiterBase::EMode::EveryFrame, 0.f);
+	}
+
+	/**
+	 * @brief イベントが途切れてから溜まったイベントをまとめて受け取ります
+	 *
+	 * 最後のイベントからQuietTime秒イベントが追加されなかった時点で再開します。
+	 * @param WorldContextObject ワールドコンテキスト
+	 * @param Queue イベントキュー
+	 * @param QuietTime イベントが途切れたとみなす時間(秒)
+	 * @return 溜まったイベント(追加順)
+	 */
+	template<class T>
+	details::TEventBatchAwaiter<T> NextBatchDebounced(const UObject*  WorldContextObject,
+	                                                  TEventQueue<T>& Queue,
+	                                                  float           QuietTime)
+	{
+		return details::TEventBatchAwaiter<T>(
+		    WorldContextObject, Queue, details::FEventBatchAwaiterBase::EMode::Debounce, QuietTime);
+	}
+
+	/**
+	 * @brief 一定間隔以上空けて溜まったイベントをまとめて受け取ります
+	 *
+	 * 前回イベントを受け取ってからInterval秒以上経過していればイベントが溜まっているフレームで再開します。
+	 * 経過時間はスケジューラーのTickで進む時刻で数える為、ワールドの時間が進まない環境でも動作します。
+	 * @param WorldContextObject ワールドコンテキスト
+	 * @param Queue イベントキュー
+	 * @param Interval 再開の最小間隔(秒)
+	 * @return 溜まったイベント(追加順)
+	 */
+	template<class T>
+	details::TEventBatchAwaiter<T> NextBatchThrottled(const UObject*  WorldContextObject,
+	                                                  TEventQueue<T>& Queue,
+	                                                  float           Interval)
+	{
+		return details::TEventBatchAwaiter<T>(
+		    WorldContextObject, Queue, details::FEventBatchAwaiterBase::EMode::Throttle, Interval);
+	}
+
+} // namespace unco
@@ -0,0 +1,117 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+// 1フレームあたりの処理量を記述する
+#pragma once
+
+#include "UncoCoreMinimal.h"
+
+namespace unco
+{
+
+	/**
+	 * @brief 1フレームあたりの処理量
+	 *
+	 * 複数を指定した場合はどれかを超えた時点でそのフレームの処理を終える。
+	 */
+	struct FFrameBudget
+	{
+		// 1フレームに使用する時間(ミリ秒)。0以下で無制限
+		float TimeMs = 0.f;
+		// 1フレームに処理する数。0以下で無制限
+		int32 Count = 0;
+		// 1フレームに使用するコスト(分散フレーム実行でco_yieldした値の合計)。0以下で無制限
+		int32 CostUnits = 0;
+
+		// 時間で指定する
+		static FFrameBudget Time(float InTimeMs)
+		{
+			return FFrameBudget{InTimeMs, 0};
+		}
+
+		// 処理数で指定する
+		static FFrameBudget Items(int32 InCount)
+		{
+			return FFrameBudget{0.f, InCount};
+		}
+
+		// co_yieldしたコストで指定する
+		static FFrameBudget Cost(int32 InUnits)
+		{
+			return FFrameBudget{0.f, 0, InUnits};
+		}
+
+		// どの項目も制限していないか？
+		bool IsUnlimited() const
+		{
+			return TimeMs <= 0.f && Count <= 0 && CostUnits <= 0;
+		}
+
+		// 処理量をScale倍にする(制限している項目は最低でも1フレームに1件進める)
+		FFrameBudget Scale(float InScale) const
+		{
+			FFrameBudget Result = *this;
+			Result.TimeMs *= InScale;
+			if ( Count > 0 )
+			{
+				Result.Count = FMath::Max(FMath::CeilToInt(Count * InScale), 1);
+			}
+			if ( CostUnits > 0 )
+			{
+				Result.CostUnits = FMath::Max(FMath::CeilToInt(CostUnits * InScale), 1);
+			}
+			return Result;
+		}
+	};
+
+	namespace details
+	{
+
+		/**
+		 * @brief 1フレーム分の処理量を計測する
+		 *
+		 * 時計の読み取りはClockInterval回に1回に間引く。
+		 */
+		struct FFrameBudgetTimer
+		{
+			explicit FFrameBudgetTimer(const FFrameBudget& InBudget, int32 InClockInterval = 1)
+			    : Budget(InBudget)
+			    , StartCycles(FPlatformTime::Cycles64())
+			    , ClockInterval(FMath::Max(InClockInterval, 1))
+			{
+			}
+
+			/**
+			 * @brief 1件処理した事を記録し、このフレームの処理を続けて良いか判定する
+			 * @return falseの場合は次のフレームに処理を持ち越す
+			 */
+			bool Step()
+			{
+				++Processed;
+				if ( Budget.Count > 0 && Processed >= Budget.Count )
+				{
+					return false;
+				}
+				if ( Budget.TimeMs > 0.f && (Processed % ClockInterval) == 0 )
+				{
+					const double ElapsedMs = FPlatformTime::ToMilliseconds64(
+					    FPlatformTime::Cycles64() - StartCycles);
+					return ElapsedMs < Budget.TimeMs;
+				}
+				return true;
+			}
+
+			// このフレームで処理した数
+			int32 Num() const
+			{
+				return Processed;
+			}
+
+		private:
+			FFrameBudget Budget;
+			uint64       StartCycles;
+			int32        ClockInterval;
+			int32        Processed = 0;
+		};
+
+	} // namespace details
+
+} // namespace unco
@@ -0,0 +1,102 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+// コルーチンのメモリ計測を記述する
+#pragma once
+
+#include "UncoCoreMinimal.h"
+#if !UNCO_STANDALONE
+	#include "HAL/LowLevelMemTracker.h"
+#endif
+#include <cstddef>
+#include <new>
+
+// コルーチンフレームの呼び出し元毎の統計を取るか？
+#ifndef UNCO_FRAME_STATS
+	#define UNCO_FRAME_STATS (!UNCO_STANDALONE && !UE_BUILD_SHIPPING)
+#endif
+
+#if UNCO_STANDALONE
+
+// エンジン外にはLLMが無いので計上しない
+	#define UNCO_LLM_SCOPE()
+
+namespace unco::details
+{
+
+	// エンジン外では呼び出し元毎の記録をせずにそのまま確保する
+	FORCEINLINE void* AllocateFrame(std::size_t Size)
+	{
+		return ::operator new(Size);
+	}
+	FORCEINLINE void FreeFrame(void* Ptr, std::size_t Size) noexcept
+	{
+		::operator delete(Ptr, Size);
+	}
+
+} // namespace unco::details
+
+#else
+
+// プラグイン内の全てのメモリ確保はこのタグに計上される
+LLM_DECLARE_TAG_API(Unco, UNREALCOROUTINE_API);
+
+// プラグイン内のメモリ確保をUncoタグに計上するスコープ
+#define UNCO_LLM_SCOPE() LLM_SCOPE_BYTAG(Unco)
+
+namespace unco::details
+{
+
+	/**
+	 * @brief コルーチンフレームを確保する
+	 *
+	 * promise_type::operator newから呼ばれる。
+	 * 呼び出し元のアドレスからコルーチン関数毎にLLMのサブタグとフレームサイズを記録する。
+	 * サブタグはアドレスで命名し、関数名のシンボル解決は統計の取得時まで行わない。
+	 * @param Size フレームサイズ
+	*/
+	UNREALCOROUTINE_API void* AllocateFrame(std::size_t Size);
+
+	/**
+	 * @brief コルーチンフレームを解放する
+	 * @param Ptr AllocateFrameで確保したフレーム
+	 * @param Size フレームサイズ
+	*/
+	UNREALCOROUTINE_API void FreeFrame(void* Ptr, std::size_t Size) noexcept;
+
+} // namespace unco::details
+
+namespace unco
+{
+
+	/**
+	 * @brief コルーチン関数毎のフレーム統計
+	*/
+	struct FCoroutineFrameStats
+	{
+		// コルーチン関数名
+		FString CallSite;
+		// フレームサイズ(byte)
+		uint32 FrameSize = 0;
+		// 生存しているフレーム数
+		int32 LiveFrames = 0;
+		// 生存しているフレーム数の最大値
+		int32 PeakFrames = 0;
+		// 累計の確保回数
+		uint64 TotalAllocations = 0;
+	};
+
+	/**
+	 * @brief コルーチン関数毎のフレーム統計を取得します
+	 * @return 生存しているフレームの合計サイズが大きい順の統計
+	 */
+	UNREALCOROUTINE_API TArray<FCoroutineFrameStats> GetCoroutineFrameStats();
+
+	/**
+	 * @brief コルーチン関数毎のフレーム統計を出力します
+	 * コンソールコマンド unco.DumpFrameStats からも出力出来ます
+	 * @param Ar 出力先
+	 */
+	UNREALCOROUTINE_API void DumpCoroutineFrameStats(FOutputDevice& Ar);
+
+} // namespace unco
+
+#endif // UNCO_STANDALONE
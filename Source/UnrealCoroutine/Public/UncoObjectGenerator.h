@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include "UncoMemory.h"
 #include <coroutine>
 #include <utility>
 
@@ -18,6 +19,9 @@ namespace unco
 		{
 		public:
 			FWeakObjectPtr HostObject;
+			// 最後にco_yieldされた値
+			// 分散フレーム実行ではそのステップのコストとして扱う
+			int32 YieldedValue = 0;
 
 			//getRetrunObjは必ず生成
 			FObjectGenerator get_return_object()
@@ -25,6 +29,17 @@ namespace unco
 				return FObjectGenerator(*this, HostObject);
 			}
 
+			// コルーチンフレームの確保
+			// LLMタグとコルーチン関数毎の統計に計上する
+			FORCEINLINE static void* operator new(std::size_t Size)
+			{
+				return details::AllocateFrame(Size);
+			}
+			FORCEINLINE static void operator delete(void* Ptr, std::size_t Size) noexcept
+			{
+				details::FreeFrame(Ptr, Size);
+			}
+
 			//初めにResume状態にする、neverはすぐに次に進む
 			constexpr std::suspend_always initial_suspend() const noexcept
 			{
@@ -40,6 +55,7 @@ namespace unco
 			//co_yieldのたびに呼ばれる、値をコピーするためのメソッド
 			constexpr std::suspend_always yield_value(int32 value) noexcept
 			{
+				YieldedValue = value;
 				return {};
 			}
 
@@ -121,6 +137,18 @@ namespace unco
 			return HostObject.IsValid();
 		}
 
+		// 呼び出し元のオブジェクト
+		UObject* GetHostObject() const
+		{
+			return HostObject.Get();
+		}
+
+		// 最後にco_yieldされた値
+		int32 GetYieldedValue() const noexcept
+		{
+			return CoroutineHandle.promise().YieldedValue;
+		}
+
 	private:
 		explicit FObjectGenerator(FPromise& InPromise, FWeakObjectPtr InHostObject)
 		    : CoroutineHandle(
@@ -1,13 +1,23 @@
 #pragma once
 
-#include "CoreMinimal.h"
+#include "UncoCoreMinimal.h"
+#include "UncoMemory.h"
+#include "UncoTrace.h"
 #include <coroutine>
 #include <utility>
 
+class UUncoScheduler;
+
 namespace unco
 {
 
 	struct FObjectTask;
+	class FTaskScope;
+
+	namespace details
+	{
+		class FTaskRegistry;
+	} // namespace details
 
 	struct UNREALCOROUTINE_API FObjectTaskPromise
 	{
@@ -29,6 +39,17 @@ namespace unco
 
 		FObjectTask get_return_object() noexcept;
 
+		// コルーチンフレームの確保
+		// LLMタグとコルーチン関数毎の統計に計上する
+		FORCEINLINE static void* operator new(std::size_t Size)
+		{
+			return details::AllocateFrame(Size);
+		}
+		FORCEINLINE static void operator delete(void* Ptr, std::size_t Size) noexcept
+		{
+			details::FreeFrame(Ptr, Size);
+		}
+
 		// コルーチン本体処理の開始前に無条件サスペンド
 		constexpr auto initial_suspend() noexcept
 		{
@@ -51,6 +72,17 @@ namespace unco
 		// co_return時に呼ばれる処理
 		inline void return_void() const noexcept {}
 
+#if UNCO_AWAIT_HOOKS_ENABLED
+		// co_await毎にサスペンド・再開をトレースする
+		// Locationの既定引数はco_awaitの位置で評価される
+		template<class T>
+		auto await_transform(T&& Awaitable,
+		                     std::source_location Location = std::source_location::current())
+		{
+			return details::MakeTracedAwaiter(Trace, std::forward<T>(Awaitable), Location);
+		}
+#endif
+
 		/**
 		 * コンストラクタ
 		 * @param InObject オブジェクト
@@ -59,6 +91,12 @@ namespace unco
 		FObjectTaskPromise(UObject& InObject, Args...)
 		    : HostObject(&InObject)
 		{
+#if UNCO_TRACE_ENABLED
+			if ( details::IsTraceEnabled() )
+			{
+				details::TraceCreate(Trace, &InObject);
+			}
+#endif
 		}
 
 		/**
@@ -69,15 +107,39 @@ namespace unco
 		FObjectTaskPromise(UObject* InObject, Args...)
 		    : HostObject(InObject)
 		{
+#if UNCO_TRACE_ENABLED
+			if ( details::IsTraceEnabled() )
+			{
+				details::TraceCreate(Trace, InObject);
+			}
+#endif
+		}
+
+#if UNCO_TRACE_ENABLED
+		~FObjectTaskPromise()
+		{
+			if ( Trace.Id != 0 )
+			{
+				details::TraceDestroy(Trace);
+			}
 		}
+#endif
 
 		// タスクの呼び出し者
 		// このオブジェクトが無効になったらコルーチンも破棄させる為に保持させる
 		FWeakObjectPtr HostObject;
-		// Promise をスケジューラーに登録したか？
-		bool bRegister = false;
+		// タスクを所有しているスコープ
+		// スコープに所有されている場合にはスケジューラーには登録されない
+		FTaskScope* Scope = nullptr;
+		// タスクを所有している登録先(スケジューラー)
+		// 登録先は破棄時に所有するタスクを全て破棄するので生ポインタで保持する
+		details::FTaskRegistry* Registry = nullptr;
 		// コルーチンが終了したか？
 		bool bFinalized = false;
+#if UNCO_AWAIT_HOOKS_ENABLED
+		// トレースの状態
+		details::FCoroutineTraceState Trace;
+#endif
 	};
 
 	/**
@@ -86,6 +148,8 @@ namespace unco
 	struct UNREALCOROUTINE_API FObjectTask
 	{
 		friend struct FObjectTaskPromise;
+		friend class FTaskScope;
+		friend class ::UUncoScheduler;
 		using promise_type = FObjectTaskPromise;
 
 		~FObjectTask();
@@ -0,0 +1,29 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+// 非同期処理の進捗を記述する
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace unco
+{
+
+	/**
+	 * @brief 非同期処理の進捗
+	 *
+	 * 対応しているAwaiterに渡すと待機中に毎フレーム更新される。
+	 * 渡さなかった場合は進捗の計算自体が行われない。
+	 * co_awaitは完了時に1度だけ再開する為、途中の進捗は値として返さず、呼び出し側(UIなど)がこの構造体をポーリングする。
+	 *
+	 * @code
+	 * unco::FAsyncProgress Progress;
+	 * LoadingWidget->Bind(&Progress);
+	 * co_await unco::AsyncLoadStreamLevel(this, LevelName, true, false, &Progress);
+	 * @endcode
+	 */
+	struct FAsyncProgress
+	{
+		// 進捗(0～1)
+		float Value = 0.f;
+	};
+
+} // namespace unco
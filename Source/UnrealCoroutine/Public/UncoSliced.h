@@ -0,0 +1,509 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+// 複数フレームに分けて処理するコンテナのアルゴリズムを記述する
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "Templates/Invoke.h"
+#include "UncoFrameBudget.h"
+#include "UncoScheduler.h"
+#include <coroutine>
+#include <type_traits>
+
+namespace unco
+{
+	namespace details
+	{
+		/**
+		 * @brief 複数フレームに分けて処理する待機の基底
+		 *
+		 * スケジューラーのTick毎に1フレームの処理量に収まる分だけ処理し、全て終わったら再開する。
+		 * 1件あたりの処理が軽い事を想定して時計の読み取りはClockInterval件毎に間引く。
+		*/
+		struct UNREALCOROUTINE_API FSlicedAwaiterBase : private FTickWaitNode
+		{
+			// 時計を読む間隔(件数)
+			static constexpr int32 ClockInterval = 32;
+
+			/**
+			 * 1フレーム分の処理
+			 * @return 全て処理し終えた場合はtrue
+			 */
+			using FRunSlice = bool (*)(FSlicedAwaiterBase& Self, FFrameBudgetTimer& Timer);
+
+			FSlicedAwaiterBase(const UObject* InWorldContext, const FFrameBudget& InBudget, FRunSlice InRunSlice);
+
+			// スケジューラーが無い場合は中断せずに全て処理する
+			bool await_suspend(std::coroutine_handle<> coroutine);
+
+		protected:
+			// ワールドコンテキストが有効か？
+			bool IsWorldContextValid() const
+			{
+				return WorldContext.IsValid();
+			}
+
+		private:
+			static bool OnTickSliced(FTickWaitNode& Node, float DeltaTime);
+
+			FWeakObjectPtr WorldContext;
+			FFrameBudget   Budget;
+			FRunSlice      RunSlice;
+		};
+
+		/**
+		 * @brief 配列の分散ForEach待機
+		*/
+		template<class ArrayType, class FuncType>
+		struct TSlicedForEachAwaiter : public FSlicedAwaiterBase
+		{
+			TSlicedForEachAwaiter(const UObject* InWorldContext, ArrayType& InItems, FuncType&& InBody, const FFrameBudget& InBudget)
+			    : FSlicedAwaiterBase(InWorldContext, InBudget, &TSlicedForEachAwaiter::RunSlice)
+			    , Items(InItems)
+			    , Body(MoveTemp(InBody))
+			{
+			}
+
+			bool await_ready() const noexcept
+			{
+				return Items.Num() == 0;
+			}
+			void await_resume() const noexcept
+			{
+			}
+
+		private:
+			static bool RunSlice(FSlicedAwaiterBase& Base, FFrameBudgetTimer& Timer)
+			{
+				TSlicedForEachAwaiter& Self = static_cast<TSlicedForEachAwaiter&>(Base);
+				// 処理中に追加された要素も処理する為、毎回要素数を確認する
+				while ( Self.Index < Self.Items.Num() )
+				{
+					Invoke(Self.Body, Self.Items[Self.Index++]);
+					if ( !Timer.Step() )
+					{
+						break;
+					}
+				}
+				return Self.Index >= Self.Items.Num();
+			}
+
+			ArrayType& Items;
+			FuncType   Body;
+			int32      Index = 0;
+		};
+
+		/**
+		 * @brief 配列の分散フィルター待機
+		*/
+		template<class T, class PredicateType>
+		struct TSlicedFilterAwaiter : public FSlicedAwaiterBase
+		{
+			TSlicedFilterAwaiter(const UObject* InWorldContext, TArray<T>&& InItems, PredicateType&& InPredicate, const FFrameBudget& InBudget)
+			    : FSlicedAwaiterBase(InWorldContext, InBudget, &TSlicedFilterAwaiter::RunSlice)
+			    , Items(MoveTemp(InItems))
+			    , Predicate(MoveTemp(InPredicate))
+			{
+			}
+
+			bool await_ready() const noexcept
+			{
+				return Items.Num() == 0;
+			}
+			[[nodiscard]] TArray<T> await_resume()
+			{
+				// 詰めた後ろの残さなかった要素を取り除く
+				Items.SetNum(WriteIndex);
+				return MoveTemp(Items);
+			}
+
+		private:
+			static bool RunSlice(FSlicedAwaiterBase& Base, FFrameBudgetTimer& Timer)
+			{
+				TSlicedFilterAwaiter& Self = static_cast<TSlicedFilterAwaiter&>(Base);
+				// 残す要素を前に詰めていく
+				while ( Self.ReadIndex < Self.Items.Num() )
+				{
+					if ( Invoke(Self.Predicate, Self.Items[Self.ReadIndex]) )
+					{
+						if ( Self.WriteIndex != Self.ReadIndex )
+						{
+							Self.Items[Self.WriteIndex] = MoveTemp(Self.Items[Self.ReadIndex]);
+						}
+						++Self.WriteIndex;
+					}
+					++Self.ReadIndex;
+
+					if ( !Timer.Step() )
+					{
+						break;
+					}
+				}
+				return Self.ReadIndex >= Self.Items.Num();
+			}
+
+			TArray<T>     Items;
+			PredicateType Predicate;
+			int32         ReadIndex  = 0;
+			int32         WriteIndex = 0;
+		};
+
+		/**
+		 * @brief 配列の分散ソート待機
+		 *
+		 * 短い区間を挿入ソートした後、ボトムアップのマージソートを1要素単位で進める。
+		 * マージの途中でもフレームを跨げる為、配列の長さに依らず1フレームの処理量を守れる。
+		 * 安定ソートで、作業領域として配列と同じ長さのバッファを使用する。
+		 * マージの途中で破棄された場合は作業領域に移した要素を配列に戻す。
+		*/
+		template<class ArrayType, class PredicateType>
+		struct TSlicedSortAwaiter : public FSlicedAwaiterBase
+		{
+			TSlicedSortAwaiter(const UObject* InWorldContext, ArrayType& InItems, PredicateType&& InPredicate, const FFrameBudget& InBudget)
+			    : FSlicedAwaiterBase(InWorldContext, InBudget, &TSlicedSortAwaiter::RunSlice)
+			    , Items(InItems)
+			    , Predicate(MoveTemp(InPredicate))
+			    , Num(InItems.Num())
+			{
+			}
+
+			~TSlicedSortAwaiter()
+			{
+				// ワールドコンテキストが破棄された場合は配列も破棄されている可能性があるので触らない
+				if ( Scratch.Num() > 0 && Items.Num() == Num && IsWorldContextValid() )
+				{
+					RestoreItems();
+				}
+			}
+
+			bool await_ready() const noexcept
+			{
+				return Num <= 1;
+			}
+			void await_resume() const noexcept
+			{
+			}
+
+		private:
+			// 挿入ソートする区間の長さ
+			static constexpr int32 RunLength = 16;
+
+			static bool RunSlice(FSlicedAwaiterBase& Base, FFrameBudgetTimer& Timer)
+			{
+				TSlicedSortAwaiter& Self = static_cast<TSlicedSortAwaiter&>(Base);
+				if ( !ensureMsgf(Self.Items.Num() == Self.Num, TEXT("SlicedSort: array was resized while sorting")) )
+				{
+					// 配列の位置が対応しないので作業領域の要素は戻せない
+					Self.Scratch.Empty();
+					return true;
+				}
+
+				while ( Self.InsertIndex < Self.Num )
+				{
+					Self.InsertStep();
+					if ( !Timer.Step() )
+					{
+						return false;
+					}
+				}
+
+				if ( Self.Width < Self.Num && Self.Scratch.Num() == 0 )
+				{
+					Self.Scratch.SetNum(Self.Num);
+					Self.BeginMerge();
+				}
+				while ( Self.Width < Self.Num )
+				{
+					Self.MergeStep();
+					if ( !Timer.Step() )
+					{
+						return false;
+					}
+				}
+
+				// 最後のマージ先が作業領域の場合は入れ替える
+				if ( Self.bResultInScratch )
+				{
+					Swap(Self.Items, Self.Scratch);
+					Self.bResultInScratch = false;
+				}
+				Self.Scratch.Empty();
+				return true;
+			}
+
+			// マージの途中で作業領域に移した要素を配列に戻す(順番はソートの途中のまま)
+			void RestoreItems()
+			{
+				if ( bResultInScratch )
+				{
+					// 配列には[0, Write)がマージ済みで、残りの要素は作業領域にある
+					int32 To = Write;
+					for ( int32 From = Read0; From < Mid; ++From )
+					{
+						Items[To++] = MoveTemp(Scratch[From]);
+					}
+					for ( int32 From = Read1; From < Num; ++From )
+					{
+						Items[To++] = MoveTemp(Scratch[From]);
+					}
+				}
+				else
+				{
+					// 配列の読み出し済みの位置[0, Read0)と[Mid, Read1)を作業領域の[0, Write)で埋める
+					int32 From = 0;
+					for ( int32 To = 0; To < Read0; ++To )
+					{
+						Items[To] = MoveTemp(Scratch[From++]);
+					}
+					for ( int32 To = Mid; To < Read1; ++To )
+					{
+						Items[To] = MoveTemp(Scratch[From++]);
+					}
+				}
+				Scratch.Empty();
+			}
+
+			// 区間内の挿入ソートを1要素進める
+			void InsertStep()
+			{
+				const int32 RunStart = InsertIndex - InsertIndex % RunLength;
+				for ( int32 Index = InsertIndex; Index > RunStart && Invoke(Predicate, Items[Index], Items[Index - 1]); --Index )
+				{
+					Swap(Items[Index], Items[Index - 1]);
+				}
+				++InsertIndex;
+			}
+
+			// 次の2区間のマージを始める
+			void BeginMerge()
+			{
+				Mid   = FMath::Min(Left + Width, Num);
+				Right = FMath::Min(Left + Width * 2, Num);
+				Read0 = Left;
+				Read1 = Mid;
+				Write = Left;
+			}
+
+			// マージを1要素進める
+			void MergeStep()
+			{
+				ArrayType& Src = bResultInScratch ? Scratch : Items;
+				ArrayType& Dst = bResultInScratch ? Items : Scratch;
+
+				// 等しい場合は前の区間を優先して安定にする
+				if ( Read0 < Mid && (Read1 >= Right || !Invoke(Predicate, Src[Read1], Src[Read0])) )
+				{
+					Dst[Write++] = MoveTemp(Src[Read0++]);
+				}
+				else
+				{
+					Dst[Write++] = MoveTemp(Src[Read1++]);
+				}
+
+				if ( Write < Right )
+				{
+					return;
+				}
+
+				Left = Right;
+				if ( Left >= Num )
+				{
+					// 1段分のマージが終わったので入れ替えて区間の長さを倍にする
+					bResultInScratch = !bResultInScratch;
+					Width *= 2;
+					Left = 0;
+				}
+				BeginMerge();
+			}
+
+			ArrayType&    Items;
+			ArrayType     Scratch;
+			PredicateType Predicate;
+			int32         Num;
+			int32         InsertIndex = 1;
+			int32         Width       = RunLength;
+			int32         Left        = 0;
+			int32         Mid         = 0;
+			int32         Right       = 0;
+			int32         Read0       = 0;
+			int32         Read1       = 0;
+			int32         Write       = 0;
+			bool          bResultInScratch = false;
+		};
+
+		/**
+		 * @brief ワールド内のアクターの分散ForEach待機の基底
+		*/
+		struct UNREALCOROUTINE_API FSlicedForEachActorAwaiterBase : public FSlicedAwaiterBase
+		{
+			FSlicedForEachActorAwaiterBase(const UObject*      InWorldContext,
+			                               TSubclassOf<AActor> InClass,
+			                               const FFrameBudget& InBudget,
+			                               FRunSlice           InRunSlice);
+
+			bool await_ready() const noexcept
+			{
+				return Actors.Num() == 0;
+			}
+			void await_resume() const noexcept
+			{
+			}
+
+		protected:
+			// 呼び出し時点のアクター
+			// フレームを跨ぐ間に破棄されたアクターは飛ばす
+			TArray<TWeakObjectPtr<AActor>> Actors;
+			int32                          Index = 0;
+		};
+
+		/**
+		 * @brief ワールド内のアクターの分散ForEach待機
+		*/
+		template<class T, class FuncType>
+		struct TSlicedForEachActorAwaiter : public FSlicedForEachActorAwaiterBase
+		{
+			TSlicedForEachActorAwaiter(const UObject* InWorldContext, FuncType&& InBody, const FFrameBudget& InBudget)
+			    : FSlicedForEachActorAwaiterBase(InWorldContext, T::StaticClass(), InBudget, &TSlicedForEachActorAwaiter::RunSlice)
+			    , Body(MoveTemp(InBody))
+			{
+			}
+
+		private:
+			static bool RunSlice(FSlicedAwaiterBase& Base, FFrameBudgetTimer& Timer)
+			{
+				TSlicedForEachActorAwaiter& Self = static_cast<TSlicedForEachActorAwaiter&>(Base);
+				while ( Self.Index < Self.Actors.Num() )
+				{
+					AActor* Actor = Self.Actors[Self.Index++].Get();
+					if ( IsValid(Actor) )
+					{
+						Invoke(Self.Body, static_cast<T*>(Actor));
+					}
+					if ( !Timer.Step() )
+					{
+						break;
+					}
+				}
+				return Self.Index >= Self.Actors.Num();
+			}
+
+			FuncType Body;
+		};
+	} // namespace details
+
+	/**
+	 * @brief 配列の各要素に対する処理を複数フレームに分けて行います
+	 *
+	 * Budgetに収まる分だけ毎フレーム処理し、全て処理したら再開します。
+	 * 配列は待機中も有効である必要があります。処理中に追加された要素も処理します。
+	 * Budgetは時間と処理数を使用します。
+	 * ワールドコンテキストが破棄された場合は再開されません。待機中にコルーチンが破棄された場合は
+	 * 処理済みの要素までで中断します(処理済みの要素は元に戻りません)。
+	 *
+	 * @code
+	 * co_await unco::SlicedForEach(this, Items, [](FItem& Item) { Item.Rebuild(); }, unco::FFrameBudget::Time(0.5f));
+	 * @endcode
+	 * @param WorldContextObject ワールドコンテキスト
+	 * @param Items 処理する配列
+	 * @param Body 要素毎の処理
+	 * @param Budget 1フレームあたりの処理量
+	 */
+	template<class T, class AllocatorType, class FuncType>
+	details::TSlicedForEachAwaiter<TArray<T, AllocatorType>, std::decay_t<FuncType>> SlicedForEach(
+	    const UObject*            WorldContextObject,
+	    TArray<T, AllocatorType>& Items,
+	    FuncType&&                Body,
+	    const FFrameBudget&       Budget = FFrameBudget::Time(1.f))
+	{
+		return details::TSlicedForEachAwaiter<TArray<T, AllocatorType>, std::decay_t<FuncType>>(
+		    WorldContextObject, Items, std::decay_t<FuncType>(Forward<FuncType>(Body)), Budget);
+	}
+
+	/**
+	 * @brief 配列の要素の絞り込みを複数フレームに分けて行います
+	 *
+	 * 配列は値で受け取る為、呼び出し元の配列は変更しません。
+	 * ワールドコンテキストが破棄された場合は再開されず、コルーチンはホストと共に破棄されます。
+	 * 待機中にコルーチンが破棄された場合は判定途中の結果も破棄されます。
+	 * @param WorldContextObject ワールドコンテキスト
+	 * @param Items 絞り込む配列
+	 * @param Predicate trueを返した要素を残す
+	 * @param Budget 1フレームあたりの処理量
+	 * @return 残った要素(元の順番)
+	 */
+	template<class T, class PredicateType>
+	details::TSlicedFilterAwaiter<T, std::decay_t<PredicateType>> SlicedFilter(
+	    const UObject*      WorldContextObject,
+	    TArray<T>           Items,
+	    PredicateType&&     Predicate,
+	    const FFrameBudget& Budget = FFrameBudget::Time(1.f))
+	{
+		return details::TSlicedFilterAwaiter<T, std::decay_t<PredicateType>>(
+		    WorldContextObject, MoveTemp(Items), std::decay_t<PredicateType>(Forward<PredicateType>(Predicate)), Budget);
+	}
+
+	/**
+	 * @brief 配列のソートを複数フレームに分けて行います
+	 *
+	 * マージソートを少しずつ進める安定ソートです。配列は待機中に変更しないで下さい。
+	 * 要素はデフォルトコンストラクト可能でムーブ可能である必要があります。
+	 * ワールドコンテキストが破棄された場合は再開されません。
+	 * 待機中にコルーチンが破棄された場合、ワールドコンテキストが有効であれば作業領域に移した要素を配列に戻します。
+	 * 要素は全て残りますが、順番はソートの途中のままです。
+	 * @param WorldContextObject ワールドコンテキスト
+	 * @param Items ソートする配列
+	 * @param Predicate 比較関数(第1引数が前に来る場合にtrue)
+	 * @param Budget 1フレームあたりの処理量
+	 */
+	template<class T, class AllocatorType, class PredicateType>
+	details::TSlicedSortAwaiter<TArray<T, AllocatorType>, std::decay_t<PredicateType>> SlicedSort(
+	    const UObject*            WorldContextObject,
+	    TArray<T, AllocatorType>& Items,
+	    PredicateType&&           Predicate,
+	    const FFrameBudget&       Budget = FFrameBudget::Time(1.f))
+	{
+		return details::TSlicedSortAwaiter<TArray<T, AllocatorType>, std::decay_t<PredicateType>>(
+		    WorldContextObject, Items, std::decay_t<PredicateType>(Forward<PredicateType>(Predicate)), Budget);
+	}
+
+	/**
+	 * @brief 配列のソートを複数フレームに分けて行います(operator<で比較)
+	 * @param WorldContextObject ワールドコンテキスト
+	 * @param Items ソートする配列
+	 * @param Budget 1フレームあたりの処理量
+	 */
+	template<class T, class AllocatorType>
+	details::TSlicedSortAwaiter<TArray<T, AllocatorType>, TLess<>> SlicedSort(
+	    const UObject*            WorldContextObject,
+	    TArray<T, AllocatorType>& Items,
+	    const FFrameBudget&       Budget = FFrameBudget::Time(1.f))
+	{
+		return details::TSlicedSortAwaiter<TArray<T, AllocatorType>, TLess<>>(
+		    WorldContextObject, Items, TLess<>(), Budget);
+	}
+
+	/**
+	 * @brief ワールド内のアクターに対する処理を複数フレームに分けて行います
+	 *
+	 * 呼び出し時点でTActorIteratorが列挙するアクターを処理します。
+	 * 待機中に破棄されたアクターは飛ばし、待機中にスポーンされたアクターは含みません。
+	 *
+	 * @code
+	 * co_await unco::SlicedForEachActor<AStaticMeshActor>(this, [](AStaticMeshActor* Actor) { ... });
+	 * @endcode
+	 * @param WorldContextObject ワールドコンテキスト
+	 * @param Body アクター毎の処理
+	 * @param Budget 1フレームあたりの処理量
+	 */
+	template<class T = AActor, class FuncType>
+	details::TSlicedForEachActorAwaiter<T, std::decay_t<FuncType>> SlicedForEachActor(
+	    const UObject*      WorldContextObject,
+	    FuncType&&          Body,
+	    const FFrameBudget& Budget = FFrameBudget::Time(1.f))
+	{
+		static_assert(std::is_base_of_v<AActor, T>, "SlicedForEachActor requires an actor class");
+		return details::TSlicedForEachActorAwaiter<T, std::decay_t<FuncType>>(
+		    WorldContextObject, std::decay_t<FuncType>(Forward<FuncType>(Body)), Budget);
+	}
+
+} // namespace unco
@@ -0,0 +1,291 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+// コルーチン間の同期プリミティブを記述する
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UncoWaitList.h"
+#include <coroutine>
+#include <utility>
+
+namespace unco
+{
+	class FAsyncSemaphore;
+	class FAsyncEvent;
+
+	/**
+	 * @brief セマフォの取得を解放するガード
+	 *
+	 * 破棄時に取得したカウントを1つ返却する。
+	 */
+	class UNREALCOROUTINE_API FAsyncSemaphoreGuard
+	{
+	public:
+		FAsyncSemaphoreGuard() = default;
+		explicit FAsyncSemaphoreGuard(FAsyncSemaphore& InSemaphore)
+		    : Semaphore(&InSemaphore)
+		{
+		}
+		~FAsyncSemaphoreGuard()
+		{
+			Release();
+		}
+
+		// コピー禁止
+		FAsyncSemaphoreGuard(const FAsyncSemaphoreGuard&) = delete;
+		void operator=(const FAsyncSemaphoreGuard&) = delete;
+
+		FAsyncSemaphoreGuard(FAsyncSemaphoreGuard&& Other) noexcept
+		    : Semaphore(std::exchange(Other.Semaphore, nullptr))
+		{
+		}
+		FAsyncSemaphoreGuard& operator=(FAsyncSemaphoreGuard&& Other) noexcept
+		{
+			if ( this != &Other )
+			{
+				Release();
+				Semaphore = std::exchange(Other.Semaphore, nullptr);
+			}
+			return *this;
+		}
+
+		// スコープの終了を待たずに返却する
+		void Release();
+
+	private:
+		FAsyncSemaphore* Semaphore = nullptr;
+	};
+
+	namespace details
+	{
+		/**
+		 * @brief セマフォの取得待機
+		*/
+		struct UNREALCOROUTINE_API FSemaphoreAwaiter : private FCoroutineWaitNode
+		{
+			explicit FSemaphoreAwaiter(FAsyncSemaphore& InSemaphore)
+			    : Semaphore(InSemaphore)
+			{
+			}
+
+			bool await_ready();
+			void await_suspend(std::coroutine_handle<> coroutine);
+			void await_resume() const noexcept
+			{
+			}
+
+		protected:
+			FAsyncSemaphore& Semaphore;
+		};
+
+		/**
+		 * @brief セマフォの取得待機(ガードを返す)
+		*/
+		struct FScopedSemaphoreAwaiter : public FSemaphoreAwaiter
+		{
+			using FSemaphoreAwaiter::FSemaphoreAwaiter;
+
+			[[nodiscard]] FAsyncSemaphoreGuard await_resume() const noexcept
+			{
+				return FAsyncSemaphoreGuard(Semaphore);
+			}
+		};
+
+		/**
+		 * @brief イベントの待機
+		*/
+		struct UNREALCOROUTINE_API FEventAwaiter : private FCoroutineWaitNode
+		{
+			explicit FEventAwaiter(FAsyncEvent& InEvent)
+			    : Event(InEvent)
+			{
+			}
+
+			bool await_ready() const noexcept;
+			void await_suspend(std::coroutine_handle<> coroutine);
+			void await_resume() const noexcept
+			{
+			}
+
+		private:
+			FAsyncEvent& Event;
+		};
+	} // namespace details
+
+	/**
+	 * @brief コルーチン用のセマフォ
+	 *
+	 * カウントが無い場合はスピンせずにco_awaitで待機し、待機はAwaiter内のノードで管理される為ヒープ確保が発生しない。
+	 * 返却されたカウントは待機している順に直接受け渡される。
+	 * ゲームスレッドからのみ使用する。待機中のコルーチンはセマフォが破棄されると再開されない。
+	 *
+	 * @code
+	 * // 同時に読み込むのは4つまで
+	 * static unco::FAsyncSemaphore LoadThrottle(4);
+	 *
+	 * unco::FAsyncSemaphoreGuard Permit = co_await LoadThrottle.ScopedAcquire();
+	 * UObject* Asset = co_await unco::AsyncLoadAsset(this, Path);
+	 * @endcode
+	 */
+	class UNREALCOROUTINE_API FAsyncSemaphore
+	{
+	public:
+		explicit FAsyncSemaphore(int32 InitialCount)
+		    : Count(FMath::Max(InitialCount, 0))
+		{
+		}
+		~FAsyncSemaphore();
+
+		// コピー禁止+ムーブ禁止
+		// 待機ノードがリストのアドレスを保持する為
+		FAsyncSemaphore(const FAsyncSemaphore&) = delete;
+		FAsyncSemaphore(FAsyncSemaphore&&)      = delete;
+		void operator=(const FAsyncSemaphore&) = delete;
+		void operator=(FAsyncSemaphore&&) = delete;
+
+		/**
+		 * @brief カウントを1つ取得する
+		 *
+		 * 取得したカウントはReleaseで返却する事。
+		 */
+		[[nodiscard]] details::FSemaphoreAwaiter Acquire()
+		{
+			return details::FSemaphoreAwaiter(*this);
+		}
+
+		/**
+		 * @brief カウントを1つ取得し、破棄時に返却するガードを返す
+		 */
+		[[nodiscard]] details::FScopedSemaphoreAwaiter ScopedAcquire()
+		{
+			return details::FScopedSemaphoreAwaiter(*this);
+		}
+
+		/**
+		 * @brief 待機せずにカウントを取得する
+		 * @return 取得出来たか
+		 */
+		bool TryAcquire();
+
+		/**
+		 * @brief カウントを1つ返却する
+		 *
+		 * 待機しているコルーチンがあれば先頭のものにカウントを渡して再開する。
+		 */
+		void Release();
+
+		// 残りのカウント
+		int32 GetCount() const
+		{
+			return Count;
+		}
+
+	private:
+		friend struct details::FSemaphoreAwaiter;
+
+		details::TWaitList<details::FCoroutineWaitNode> Waiters;
+		int32                                           Count;
+	};
+
+	/**
+	 * @brief コルーチン用のミューテックス
+	 *
+	 * 同時に1つのコルーチンのみが処理を行う区間を作る。
+	 * 再入には対応していない。
+	 *
+	 * @code
+	 * unco::FAsyncSemaphoreGuard Lock = co_await Mutex.ScopedLock();
+	 * @endcode
+	 */
+	class UNREALCOROUTINE_API FAsyncMutex
+	{
+	public:
+		FAsyncMutex()
+		    : Semaphore(1)
+		{
+		}
+
+		[[nodiscard]] details::FSemaphoreAwaiter Lock()
+		{
+			return Semaphore.Acquire();
+		}
+
+		[[nodiscard]] details::FScopedSemaphoreAwaiter ScopedLock()
+		{
+			return Semaphore.ScopedAcquire();
+		}
+
+		bool TryLock()
+		{
+			return Semaphore.TryAcquire();
+		}
+
+		void Unlock()
+		{
+			Semaphore.Release();
+		}
+
+		bool IsLocked() const
+		{
+			return Semaphore.GetCount() == 0;
+		}
+
+	private:
+		FAsyncSemaphore Semaphore;
+	};
+
+	/**
+	 * @brief コルーチン用のイベント
+	 *
+	 * Setされるまで待機し、Setで待機している全てのコルーチンをまとめて再開する。
+	 * Resetするまではシグナル状態が維持される。
+	 */
+	class UNREALCOROUTINE_API FAsyncEvent
+	{
+	public:
+		explicit FAsyncEvent(bool bInitiallySet = false)
+		    : bSet(bInitiallySet)
+		{
+		}
+		~FAsyncEvent();
+
+		// コピー禁止+ムーブ禁止
+		// 待機ノードがリストのアドレスを保持する為
+		FAsyncEvent(const FAsyncEvent&) = delete;
+		FAsyncEvent(FAsyncEvent&&)      = delete;
+		void operator=(const FAsyncEvent&) = delete;
+		void operator=(FAsyncEvent&&) = delete;
+
+		/**
+		 * @brief シグナル状態になるまで待機する
+		 */
+		[[nodiscard]] details::FEventAwaiter Wait()
+		{
+			return details::FEventAwaiter(*this);
+		}
+
+		/**
+		 * @brief シグナル状態にして待機している全てのコルーチンを再開する
+		 */
+		void Set();
+
+		/**
+		 * @brief 非シグナル状態に戻す
+		 */
+		void Reset()
+		{
+			bSet = false;
+		}
+
+		bool IsSet() const
+		{
+			return bSet;
+		}
+
+	private:
+		friend struct details::FEventAwaiter;
+
+		details::TWaitList<details::FCoroutineWaitNode> Waiters;
+		bool                                            bSet;
+	};
+
+} // namespace unco
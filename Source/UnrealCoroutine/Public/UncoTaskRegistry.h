@@ -0,0 +1,127 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+// 実行中のタスクの所有を記述する
+#pragma once
+
+#include "UncoCoreMinimal.h"
+#include "UncoObjectTask.h"
+#include <coroutine>
+
+namespace unco
+{
+	namespace details
+	{
+		class FTaskRegistry;
+	} // namespace details
+
+	struct FCacheObjectTask
+	{
+
+		friend class details::FTaskRegistry;
+		using promise_type = unco::FObjectTaskPromise;
+
+		explicit FCacheObjectTask(std::coroutine_handle<promise_type> p, FWeakObjectPtr InObjectPtr) noexcept
+		    : CoroutineHandle(p)
+		    , HostObject(InObjectPtr)
+		{
+		}
+
+		~FCacheObjectTask();
+
+		// コピー禁止+ムーブ禁止
+		// メンバ変数に持たせない為
+		FCacheObjectTask(const FCacheObjectTask&) = delete;
+		void operator=(const FCacheObjectTask&) = delete;
+		FCacheObjectTask(FCacheObjectTask&&)    = delete;
+		void operator=(FCacheObjectTask&&) = delete;
+
+		bool IsValid() const;
+
+		// コルーチンが終了しているか？
+		bool IsFinalized() const;
+
+	private:
+		std::coroutine_handle<promise_type> CoroutineHandle;
+		FWeakObjectPtr                      HostObject;
+	};
+
+	namespace details
+	{
+
+		/**
+		 * @brief 戻り値を破棄された実行中のタスクを所有する
+		 *
+		 * スケジューラーが1つ保持し、終了したタスクはCollectでまとめて破棄する。
+		 * タスクのPromiseは登録先を生ポインタで保持するが、登録先は破棄時に所有するタスクを全て破棄するので
+		 * 登録先より長く生存するタスクは無い。
+		*/
+		class UNREALCOROUTINE_API FTaskRegistry
+		{
+		public:
+			FTaskRegistry() = default;
+			~FTaskRegistry();
+
+			// コピー禁止+ムーブ禁止
+			// タスクが登録先のアドレスを保持する為
+			FTaskRegistry(const FTaskRegistry&) = delete;
+			FTaskRegistry(FTaskRegistry&&)      = delete;
+			void operator=(const FTaskRegistry&) = delete;
+			void operator=(FTaskRegistry&&) = delete;
+
+			/**
+			 * @brief 実行中のタスクを所有する
+			 * @param HostObject タスクの呼び出し元オブジェクト
+			 * @param Handle 最初のサスペンドまでに終了していないコルーチン
+			 */
+			void Register(FWeakObjectPtr HostObject, std::coroutine_handle<FObjectTaskPromise> Handle);
+
+			// タスクの終了通知
+			// 呼び出し元はコルーチンの最終サスペンド中なのでここでは破棄しない
+			void OnTaskFinished()
+			{
+				++NumFinished;
+			}
+
+			// 破棄待ちのタスクがあるか？
+			bool HasFinishedTasks() const
+			{
+				return NumFinished > 0;
+			}
+
+			/**
+			 * @brief 終了したタスクをまとめて破棄する
+			 *
+			 * 破棄するタスクを一覧から取り除いてから破棄する為、
+			 * 破棄中のAwaiterのデストラクタからタスクが登録されても良い。
+			 * @param bSweepHosts 呼び出し元オブジェクトが破棄されたタスクも破棄するか
+			 */
+			void Collect(bool bSweepHosts);
+
+			// 全てのタスクを破棄する
+			void Reset();
+
+			// 所有しているタスク数
+			int32 Num() const
+			{
+				return Tasks.Num();
+			}
+
+		private:
+			TArray<FCacheObjectTask> Tasks;
+			// Collectで破棄するタスクのハンドルの一時領域
+			TArray<std::coroutine_handle<FObjectTaskPromise>> DestroyBuffer;
+			int32                    NumFinished = 0;
+		};
+
+		/**
+		 * @brief ホストオブジェクトのタスクを所有する登録先を取得する
+		 *
+		 * エンジンではホストオブジェクトのスケジューラーの登録先を返す(UncoScheduler.cpp)。
+		 * スタンドアロンのビルドではビルドする側が定義する。
+		 * @param Host タスクの呼び出し元オブジェクト
+		 * @return 登録先が無い場合はnullptr
+		*/
+		FTaskRegistry* FindTaskRegistry(const UObject* Host);
+
+	} // namespace details
+
+} // namespace unco
@@ -0,0 +1,107 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+// 子タスクをまとめて管理するスコープを記述する
+#pragma once
+
+#include "UncoCoreMinimal.h"
+#include "UncoObjectTask.h"
+#include "UncoWaitList.h"
+#include <coroutine>
+
+namespace unco
+{
+	class FTaskScope;
+
+	namespace details
+	{
+		/**
+		 * @brief スコープの全ての子タスクの終了待機
+		*/
+		struct UNREALCOROUTINE_API FTaskScopeAwaiter : private FCoroutineWaitNode
+		{
+			explicit FTaskScopeAwaiter(FTaskScope& InScope)
+			    : Scope(InScope)
+			{
+			}
+
+			bool await_ready() const noexcept;
+			void await_suspend(std::coroutine_handle<> coroutine);
+			void await_resume();
+
+		private:
+			FTaskScope& Scope;
+		};
+	} // namespace details
+
+	/**
+	 * @brief 子タスクを所有するスコープ
+	 *
+	 * Spawnした子タスクはスケジューラーではなくスコープに所有され、
+	 * WaitAllで全ての終了を待機出来る。
+	 * スコープの破棄・Cancel時には未完了の子タスクをまとめて破棄する。
+	 *
+	 * @code
+	 * unco::FTaskScope Scope;
+	 * for ( AActor* Actor : Actors )
+	 * {
+	 *     Scope.Spawn(InitializeActor(Actor));
+	 * }
+	 * co_await Scope.WaitAll();
+	 * @endcode
+	 */
+	class UNREALCOROUTINE_API FTaskScope
+	{
+	public:
+		FTaskScope() = default;
+		~FTaskScope();
+
+		// コピー禁止+ムーブ禁止
+		// 子タスクがスコープのアドレスを保持する為
+		FTaskScope(const FTaskScope&) = delete;
+		FTaskScope(FTaskScope&&)      = delete;
+		void operator=(const FTaskScope&) = delete;
+		void operator=(FTaskScope&&) = delete;
+
+		/**
+		 * @brief 子タスクをスコープに所有させる
+		 * @param Task コルーチン関数の戻り値
+		 */
+		void Spawn(FObjectTask&& Task);
+
+		/**
+		 * @brief 全ての子タスクの終了を待機する
+		 */
+		[[nodiscard]] details::FTaskScopeAwaiter WaitAll()
+		{
+			return details::FTaskScopeAwaiter(*this);
+		}
+
+		/**
+		 * @brief 未完了の子タスクを全て破棄する
+		 *
+		 * WaitAllで待機しているコルーチンは再開される。
+		 * 子タスク自身から呼び出してはいけない。
+		 */
+		void Cancel();
+
+		// 実行中の子タスク数
+		int32 Num() const
+		{
+			return NumRunning;
+		}
+
+	private:
+		friend struct FObjectTaskPromise;
+		friend struct details::FTaskScopeAwaiter;
+
+		// 子タスクの終了通知
+		void OnChildFinished();
+		// 終了した子タスクをまとめて破棄する
+		void CollectFinished();
+
+		TArray<std::coroutine_handle<FObjectTaskPromise>>     Children;
+		details::TWaitList<details::FCoroutineWaitNode>       Joiners;
+		int32                                                 NumRunning  = 0;
+		int32                                                 NumFinished = 0;
+	};
+
+} // namespace unco
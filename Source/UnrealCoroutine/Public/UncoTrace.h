@@ -0,0 +1,294 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+// Unreal Insights向けのコルーチンのトレースを記述する
+#pragma once
+
+#include "UncoCoreMinimal.h"
+#if !UNCO_STANDALONE
+	#include "Trace/Trace.h"
+#endif
+#include <coroutine>
+#include <source_location>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+// コルーチンのトレースを行うか？
+#ifndef UNCO_TRACE_ENABLED
+	#define UNCO_TRACE_ENABLED (!UNCO_STANDALONE && UE_TRACE_ENABLED && !UE_BUILD_SHIPPING)
+#endif
+
+// 長時間の再開を検出するか？
+#ifndef UNCO_WATCHDOG_ENABLED
+	#define UNCO_WATCHDOG_ENABLED (!UNCO_STANDALONE && !UE_BUILD_SHIPPING)
+#endif
+
+// co_await毎にフックを挟むか？
+#define UNCO_AWAIT_HOOKS_ENABLED (UNCO_TRACE_ENABLED || UNCO_WATCHDOG_ENABLED)
+
+#if UNCO_TRACE_ENABLED
+// -trace=unco で有効になるトレースチャンネル
+UE_TRACE_CHANNEL_EXTERN(UncoChannel, UNREALCOROUTINE_API);
+#endif
+
+#if UNCO_AWAIT_HOOKS_ENABLED
+
+namespace unco::details
+{
+
+	/**
+	 * @brief コルーチンが再開された要因
+	*/
+	enum class ETraceWakeReason : uint8
+	{
+		// 他のコルーチンや通常のコードから直接再開された
+		Direct,
+		// スケジューラーの再開キュー
+		Ready,
+		// スケジューラーのTick待機
+		Tick,
+		// 分散フレーム実行
+		DistributedFrame,
+	};
+
+	/**
+	 * @brief コルーチン毎のトレース状態
+	 *
+	 * promise_typeに持たせる。
+	 * IDはチャンネルが有効な時に初めてイベントを出力する時点で割り当てる。
+	*/
+	struct FCoroutineTraceState
+	{
+	#if UNCO_TRACE_ENABLED
+		// コルーチンの識別子(0は未割り当て)
+		uint64 Id = 0;
+		// このコルーチンを再開したコルーチン
+		// サスペンド時に実行中のコルーチンを戻す為に使用する
+		uint64 ResumerId = 0;
+		// サスペンドしたコルーチン関数名
+		const ANSICHAR* FunctionName = nullptr;
+		// CPUスコープを開始しているか？
+		bool bSpanOpen = false;
+	#endif
+	#if UNCO_WATCHDOG_ENABLED
+		// 再開した時刻(0は計測していない)
+		uint64 SliceStartCycles = 0;
+		// 再開前に待機していたAwaiterと位置
+		std::string_view     SliceAwaiter;
+		std::source_location SliceLocation;
+	#endif
+	};
+
+	#if UNCO_TRACE_ENABLED
+
+	// トレースチャンネルが有効か？
+	FORCEINLINE bool IsTraceEnabled()
+	{
+		return UE_TRACE_CHANNELEXPR_IS_ENABLED(UncoChannel);
+	}
+
+	UNREALCOROUTINE_API void TraceCreate(FCoroutineTraceState& State, const UObject* HostObject);
+	UNREALCOROUTINE_API void TraceSuspend(FCoroutineTraceState&       State,
+	                                      std::string_view            AwaiterType,
+	                                      const std::source_location& Location);
+	UNREALCOROUTINE_API void TraceResume(FCoroutineTraceState& State);
+	UNREALCOROUTINE_API void TraceFinish(FCoroutineTraceState& State);
+	UNREALCOROUTINE_API void TraceDestroy(FCoroutineTraceState& State);
+
+	/**
+	 * @brief スコープ内で再開されるコルーチンの再開要因を設定する
+	*/
+	struct UNREALCOROUTINE_API FTraceWakeScope
+	{
+		explicit FTraceWakeScope(ETraceWakeReason Reason);
+		~FTraceWakeScope();
+
+	private:
+		ETraceWakeReason PrevReason;
+	};
+
+	/**
+	 * @brief チャンネルが有効な場合のみ名前付きのCPUスコープを出力する
+	*/
+	struct UNREALCOROUTINE_API FTraceCpuScope
+	{
+		explicit FTraceCpuScope(const UObject* HostObject);
+		~FTraceCpuScope();
+
+	private:
+		bool bOpen = false;
+	};
+
+	#endif // UNCO_TRACE_ENABLED
+
+	#if UNCO_WATCHDOG_ENABLED
+
+	// 再開1回あたりの閾値(0の場合は無効)
+	// コンソール変数 unco.SliceWatchdogThresholdMs から更新される
+	extern UNREALCOROUTINE_API uint64 GSliceThresholdCycles;
+
+	FORCEINLINE bool IsSliceWatchdogEnabled()
+	{
+		return GSliceThresholdCycles != 0;
+	}
+
+	// 再開時の時刻と再開前のAwaiterを記録する
+	FORCEINLINE void BeginSlice(FCoroutineTraceState&       State,
+	                            std::string_view            AwaiterType,
+	                            const std::source_location& Location)
+	{
+		State.SliceStartCycles = FPlatformTime::Cycles64();
+		State.SliceAwaiter     = AwaiterType;
+		State.SliceLocation    = Location;
+	}
+
+	// 閾値を超えた再開を記録する
+	UNREALCOROUTINE_API void ReportLongSlice(const FCoroutineTraceState& State, uint64 Cycles);
+
+	// 再開からサスペンド・終了までの時間を判定する
+	FORCEINLINE void EndSlice(FCoroutineTraceState& State)
+	{
+		if ( State.SliceStartCycles == 0 )
+		{
+			return;
+		}
+		const uint64 Cycles    = FPlatformTime::Cycles64() - State.SliceStartCycles;
+		State.SliceStartCycles = 0;
+		if ( GSliceThresholdCycles != 0 && Cycles > GSliceThresholdCycles )
+		{
+			ReportLongSlice(State, Cycles);
+		}
+	}
+
+	#endif // UNCO_WATCHDOG_ENABLED
+
+	/**
+	 * @brief 型名をコンパイル時に取得する
+	*/
+	template<class T>
+	constexpr std::string_view GetTraceTypeName()
+	{
+	#if defined(_MSC_VER) && !defined(__clang__)
+		constexpr std::string_view Signature = __FUNCSIG__;
+		constexpr std::string_view Prefix    = "GetTraceTypeName<";
+		constexpr std::string_view Suffix    = ">(void)";
+	#else
+		constexpr std::string_view Signature = __PRETTY_FUNCTION__;
+		constexpr std::string_view Prefix    = "T = ";
+		constexpr std::string_view Suffix    = "]";
+	#endif
+		const std::size_t Begin = Signature.find(Prefix);
+		if ( Begin == std::string_view::npos )
+		{
+			return Signature;
+		}
+		const std::size_t NameBegin = Begin + Prefix.size();
+		std::size_t       NameEnd   = Signature.rfind(Suffix);
+		// GCCは "[with T = X; ...]" の形式
+		const std::size_t Separator = Signature.find(';', NameBegin);
+		if ( Separator != std::string_view::npos && Separator < NameEnd )
+		{
+			NameEnd = Separator;
+		}
+		return Signature.substr(NameBegin, NameEnd - NameBegin);
+	}
+
+	/**
+	 * @brief co_awaitのサスペンド・再開をフックするラッパー
+	 *
+	 * promise_type::await_transformから生成され、トレースと長時間の再開の検出を行う。
+	 * 元のAwaiterは一時オブジェクトでもco_awaitの完全式の間は生存するので参照で保持する。
+	 * @tparam TAwaiter 元のAwaiterの型(参照またはoperator co_awaitの戻り値)
+	*/
+	template<class TAwaiter>
+	struct TTracedAwaiter
+	{
+		using FInner = std::remove_cvref_t<TAwaiter>;
+
+		TAwaiter              Inner;
+		FCoroutineTraceState& State;
+		std::source_location  Location;
+		bool                  bSuspended = false;
+
+		bool await_ready()
+		{
+			return Inner.await_ready();
+		}
+
+		template<class TPromise>
+		decltype(auto) await_suspend(std::coroutine_handle<TPromise> coroutine)
+		{
+			// 元のAwaiterのawait_suspend内で再開・破棄される可能性があるので先に行う
+			bSuspended = true;
+	#if UNCO_WATCHDOG_ENABLED
+			EndSlice(State);
+	#endif
+	#if UNCO_TRACE_ENABLED
+			if ( IsTraceEnabled() )
+			{
+				TraceSuspend(State, GetTraceTypeName<FInner>(), Location);
+			}
+	#endif
+			return Inner.await_suspend(coroutine);
+		}
+
+		decltype(auto) await_resume()
+		{
+			if ( bSuspended )
+			{
+	#if UNCO_TRACE_ENABLED
+				if ( IsTraceEnabled() )
+				{
+					TraceResume(State);
+				}
+	#endif
+	#if UNCO_WATCHDOG_ENABLED
+				if ( IsSliceWatchdogEnabled() )
+				{
+					BeginSlice(State, GetTraceTypeName<FInner>(), Location);
+				}
+	#endif
+			}
+			return Inner.await_resume();
+		}
+	};
+
+	template<class T>
+	concept CMemberCoAwait = requires(T&& Awaitable) {
+		std::forward<T>(Awaitable).operator co_await();
+	};
+
+	/**
+	 * @brief フック用のラッパーを生成する
+	 * @param State コルーチンのトレース状態
+	 * @param Awaitable co_awaitの対象
+	 * @param Location co_awaitの位置
+	*/
+	template<class T>
+	auto MakeTracedAwaiter(FCoroutineTraceState& State, T&& Awaitable, const std::source_location& Location)
+	{
+		if constexpr ( CMemberCoAwait<T> )
+		{
+			using FAwaiter = decltype(std::forward<T>(Awaitable).operator co_await());
+			return TTracedAwaiter<FAwaiter>{std::forward<T>(Awaitable).operator co_await(), State, Location};
+		}
+		else
+		{
+			return TTracedAwaiter<T&&>{std::forward<T>(Awaitable), State, Location};
+		}
+	}
+
+} // namespace unco::details
+
+#endif // UNCO_AWAIT_HOOKS_ENABLED
+
+#if UNCO_TRACE_ENABLED
+	// スコープ内で再開されるコルーチンの再開要因を設定する
+	#define UNCO_TRACE_WAKE_SCOPE(Reason) \
+		::unco::details::FTraceWakeScope PREPROCESSOR_JOIN(UncoTraceWakeScope, __LINE__)(::unco::details::ETraceWakeReason::Reason)
+	// チャンネルが有効な場合にホストオブジェクト名のCPUスコープを出力する
+	#define UNCO_TRACE_CPU_SCOPE(HostObject) \
+		::unco::details::FTraceCpuScope PREPROCESSOR_JOIN(UncoTraceCpuScope, __LINE__)(HostObject)
+#else
+	#define UNCO_TRACE_WAKE_SCOPE(Reason)
+	#define UNCO_TRACE_CPU_SCOPE(HostObject)
+#endif // UNCO_TRACE_ENABLED
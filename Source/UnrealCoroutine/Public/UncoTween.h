@@ -0,0 +1,264 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+// 値の補間(トゥイーン)の待機を記述する
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/Invoke.h"
+#include "UncoWaitList.h"
+#include <coroutine>
+#include <type_traits>
+
+class UUncoScheduler;
+
+namespace unco
+{
+	/**
+	 * @brief トゥイーンのイージング
+	 */
+	enum class ETweenEasing : uint8
+	{
+		Linear,
+		// 3次関数で加速する
+		EaseIn,
+		// 3次関数で減速する
+		EaseOut,
+		// 3次関数で加速して減速する
+		EaseInOut,
+		// 正弦波で加速して減速する
+		SinusoidalInOut,
+		// エルミート補間(SmoothStep)
+		SmoothStep,
+	};
+
+	namespace details
+	{
+		/**
+		 * @brief トゥイーンの待機ノード
+		 *
+		 * 補間の進行はスケジューラーがまとめて計算し、ノードには補間した値の反映だけを行わせる。
+		*/
+		struct UNREALCOROUTINE_API FTweenNode : public FCoroutineWaitNode
+		{
+			/**
+			 * 補間した値を反映する
+			 * @param Node 待機ノード
+			 * @param Alpha イージング適用後の進行度(0～1)
+			 */
+			using FApply = void (*)(FTweenNode& Node, float Alpha);
+
+			FTweenNode() = default;
+			~FTweenNode();
+
+			// コピーされたノードは登録を引き継がない
+			FTweenNode(const FTweenNode& Other) noexcept
+			    : FCoroutineWaitNode(Other)
+			    , Apply(Other.Apply)
+			{
+			}
+			void operator=(const FTweenNode&) = delete;
+
+			/**
+			 * @brief ワールドコンテキストのスケジューラーに登録してコルーチンを待機させる
+			 *
+			 * ワールドコンテキストが破棄された場合、スケジューラーは値の反映も再開も行わずに登録を解除する。
+			 * @param WorldContext ワールドコンテキスト
+			 * @param coroutine 再開するコルーチン
+			 * @param InApply 値の反映
+			 * @param Duration 補間時間(秒)
+			 * @param Easing イージング
+			 * @return スケジューラーが無く登録出来なかった場合はfalse
+			 */
+			bool SuspendTween(const UObject*          WorldContext,
+			                  std::coroutine_handle<> coroutine,
+			                  FApply                  InApply,
+			                  float                   Duration,
+			                  ETweenEasing            Easing);
+
+			FApply Apply = nullptr;
+
+		private:
+			friend class FTweenSet;
+
+			TWeakObjectPtr<UUncoScheduler> Scheduler;
+			// SuspendTweenのワールドコンテキスト
+			FWeakObjectPtr ContextObject;
+			// トゥイーン集合の配列上の位置(bPendingAddの場合は追加待ちの配列上の位置)
+			int32 TweenIndex = INDEX_NONE;
+			// トゥイーンを進めている最中に登録され、追加待ちになっているか？
+			bool bPendingAdd = false;
+		};
+
+		/**
+		 * @brief スケジューラーが保持する実行中のトゥイーンの集合
+		 *
+		 * 経過時間・進行度などを要素毎の配列(Structure of Arrays)で保持し、
+		 * Tick毎に1度のループでまとめて進める。補間が終わったノードのコルーチンだけを再開する。
+		 * 進めている最中(設定関数の中)の追加は追加待ちに積み、削除は要素を空にしておき、
+		 * どちらも進め終わった後で反映する。
+		*/
+		class UNREALCOROUTINE_API FTweenSet
+		{
+		public:
+			FTweenSet() = default;
+			~FTweenSet();
+
+			// コピー禁止
+			// ノードが登録先の位置を保持する為
+			FTweenSet(const FTweenSet&) = delete;
+			void operator=(const FTweenSet&) = delete;
+
+			void Add(FTweenNode& Node, UUncoScheduler* Scheduler, float Duration, ETweenEasing Easing);
+			void Remove(FTweenNode& Node);
+			// 登録されている全てのノードを切り離す
+			void Reset();
+
+			/**
+			 * @brief 全てのトゥイーンを進める
+			 *
+			 * ワールドコンテキストが破棄されたノードは値を反映せず、再開もせずに取り除く。
+			 * @param DeltaTime 経過時間
+			 * @param OutFinished 補間が終わったノードの追加先
+			 */
+			void Advance(float DeltaTime, TWaitList<FCoroutineWaitNode>& OutFinished);
+
+			int32 Num() const
+			{
+				return Nodes.Num();
+			}
+
+		private:
+			// 進めている最中に追加されたトゥイーン
+			struct FPendingTween
+			{
+				FTweenNode*  Node;
+				float        Duration;
+				ETweenEasing Easing;
+			};
+
+			TArray<float>         Elapsed;
+			TArray<float>         InvDuration;
+			TArray<float>         Alpha;
+			TArray<ETweenEasing>  Easings;
+			// 進めている最中に削除された要素はnullptr
+			TArray<FTweenNode*>   Nodes;
+			TArray<FPendingTween> PendingAdds;
+			bool                  bAdvancing = false;
+		};
+
+		// イージングを適用する
+		UNREALCOROUTINE_API float ApplyEasing(ETweenEasing Easing, float Alpha);
+
+		/**
+		 * @brief トゥイーンの待機
+		*/
+		template<class T, class SetterType>
+		struct TTweenAwaiter : private FTweenNode
+		{
+			TTweenAwaiter(const UObject* InWorldContext,
+			              SetterType&&   InSetter,
+			              const T&       InFrom,
+			              const T&       InTo,
+			              float          InDuration,
+			              ETweenEasing   InEasing)
+			    : WorldContext(InWorldContext)
+			    , Setter(MoveTemp(InSetter))
+			    , From(InFrom)
+			    , To(InTo)
+			    , Duration(InDuration)
+			    , Easing(InEasing)
+			{
+			}
+
+			// 補間時間が無い場合は最終値を設定して待機しない
+			bool await_ready()
+			{
+				if ( Duration > 0.f )
+				{
+					return false;
+				}
+				Invoke(Setter, To);
+				return true;
+			}
+			// スケジューラーが無い場合は最終値を設定して中断しない
+			bool await_suspend(std::coroutine_handle<> coroutine)
+			{
+				Invoke(Setter, From);
+				if ( SuspendTween(WorldContext.Get(), coroutine, &TTweenAwaiter::ApplyAlpha, Duration, Easing) )
+				{
+					return true;
+				}
+				Invoke(Setter, To);
+				return false;
+			}
+			constexpr void await_resume() const noexcept
+			{
+			}
+
+		private:
+			static void ApplyAlpha(FTweenNode& Node, float Alpha)
+			{
+				TTweenAwaiter& Self = static_cast<TTweenAwaiter&>(Node);
+				Invoke(Self.Setter, static_cast<T>(FMath::Lerp(Self.From, Self.To, Alpha)));
+			}
+
+			FWeakObjectPtr WorldContext;
+			SetterType     Setter;
+			T              From;
+			T              To;
+			float          Duration;
+			ETweenEasing   Easing;
+		};
+	} // namespace details
+
+	/**
+	 * @brief 値を補間しながら設定し、補間が終わったら再開します
+	 *
+	 * 補間はスケジューラーが全てのトゥイーンをまとめて進め、コルーチンは終了時に1度だけ再開されます。
+	 * 設定関数の中で(デリゲート経由などで)トゥイーンが開始・中断されても安全で、開始したトゥイーンは次のTickから進みます。
+	 *
+	 * @code
+	 * co_await unco::Tween(this, [this](const FVector& Location) { SetActorLocation(Location); },
+	 *                      GetActorLocation(), TargetLocation, 0.5f, unco::ETweenEasing::EaseOut);
+	 * @endcode
+	 * @param WorldContextObject ワールドコンテキスト
+	 * @param Setter 補間した値を設定する関数
+	 * @param From 開始値
+	 * @param To 終了値
+	 * @param Duration 補間時間(秒)
+	 * @param Easing イージング
+	 */
+	template<class T, class SetterType, std::enable_if_t<std::is_invocable_v<SetterType&, const T&>, int> = 0>
+	details::TTweenAwaiter<T, std::decay_t<SetterType>> Tween(const UObject* WorldContextObject,
+	                                                          SetterType&&   Setter,
+	                                                          const T&       From,
+	                                                          const T&       To,
+	                                                          float          Duration,
+	                                                          ETweenEasing   Easing = ETweenEasing::Linear)
+	{
+		return details::TTweenAwaiter<T, std::decay_t<SetterType>>(
+		    WorldContextObject, std::decay_t<SetterType>(Forward<SetterType>(Setter)), From, To, Duration, Easing);
+	}
+
+	/**
+	 * @brief 変数を補間しながら設定し、補間が終わったら再開します
+	 *
+	 * 変数は待機中も有効である必要があります(ワールドコンテキストのメンバーなど)。
+	 * @param WorldContextObject ワールドコンテキスト
+	 * @param Property 設定する変数
+	 * @param From 開始値
+	 * @param To 終了値
+	 * @param Duration 補間時間(秒)
+	 * @param Easing イージング
+	 */
+	template<class T>
+	auto Tween(const UObject* WorldContextObject,
+	           T&             Property,
+	           const T&       From,
+	           const T&       To,
+	           float          Duration,
+	           ETweenEasing   Easing = ETweenEasing::Linear)
+	{
+		return Tween(WorldContextObject, [&Property](const T& Value) { Property = Value; }, From, To, Duration, Easing);
+	}
+
+} // namespace unco
@@ -0,0 +1,191 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+// 侵入型の待機リストを記述する
+#pragma once
+
+#include "UncoCoreMinimal.h"
+#include <coroutine>
+
+namespace unco::details
+{
+
+	/**
+	 * @brief 侵入型の待機ノード
+	 *
+	 * Awaiterのメンバー(=コルーチンフレーム内)に配置する事で
+	 * 待機リストへの登録時にヒープ確保が発生しない。
+	 * 破棄時には自動的にリストから外れる。
+	*/
+	struct FWaitNode
+	{
+		FWaitNode() noexcept
+		    : Prev(this)
+		    , Next(this)
+		{
+		}
+
+		~FWaitNode()
+		{
+			Unlink();
+		}
+
+		// コピーされたノードはリンクを引き継がない
+		FWaitNode(const FWaitNode&) noexcept
+		    : FWaitNode()
+		{
+		}
+		FWaitNode& operator=(const FWaitNode&) noexcept
+		{
+			return *this;
+		}
+
+		// いずれかのリストに登録されているか？
+		bool IsLinked() const noexcept
+		{
+			return Next != this;
+		}
+
+		// 登録されているリストから外す
+		void Unlink() noexcept
+		{
+			Prev->Next = Next;
+			Next->Prev = Prev;
+			Prev       = this;
+			Next       = this;
+		}
+
+	private:
+		friend struct FWaitList;
+
+		FWaitNode* Prev;
+		FWaitNode* Next;
+	};
+
+	/**
+	 * @brief コルーチンを再開するだけの待機ノード
+	*/
+	struct FCoroutineWaitNode : public FWaitNode
+	{
+		std::coroutine_handle<> Coroutine;
+	};
+
+	/**
+	 * @brief 侵入型の待機リスト
+	 *
+	 * ノードの所有権は持たない。
+	 * リストが先に破棄された場合には登録されているノードを全て切り離す。
+	*/
+	struct FWaitList
+	{
+		FWaitList() = default;
+		~FWaitList()
+		{
+			Reset();
+		}
+
+		// コピー禁止+ムーブ禁止
+		// ノードがHeadのアドレスを保持する為
+		FWaitList(const FWaitList&) = delete;
+		FWaitList(FWaitList&&)      = delete;
+		void operator=(const FWaitList&) = delete;
+		void operator=(FWaitList&&) = delete;
+
+		bool IsEmpty() const noexcept
+		{
+			return !Head.IsLinked();
+		}
+
+		// 末尾に追加する
+		void PushBack(FWaitNode& Node) noexcept
+		{
+			Node.Unlink();
+			Node.Prev       = Head.Prev;
+			Node.Next       = &Head;
+			Head.Prev->Next = &Node;
+			Head.Prev       = &Node;
+		}
+
+		// 先頭を取り出す
+		FWaitNode* PopFront() noexcept
+		{
+			if ( IsEmpty() )
+			{
+				return nullptr;
+			}
+			FWaitNode* Node = Head.Next;
+			Node->Unlink();
+			return Node;
+		}
+
+		// 別リストのノードを全て末尾に移動する
+		void Append(FWaitList& Other) noexcept
+		{
+			if ( &Other == this || Other.IsEmpty() )
+			{
+				return;
+			}
+			FWaitNode* First = Other.Head.Next;
+			FWaitNode* Last  = Other.Head.Prev;
+
+			First->Prev     = Head.Prev;
+			Head.Prev->Next = First;
+			Last->Next      = &Head;
+			Head.Prev       = Last;
+
+			Other.Head.Prev = &Other.Head;
+			Other.Head.Next = &Other.Head;
+		}
+
+		// 登録されている全てのノードを切り離す
+		void Reset() noexcept
+		{
+			while ( PopFront() != nullptr )
+			{
+			}
+		}
+
+		// 登録数を数える(O(n))
+		int32 Num() const noexcept
+		{
+			int32 Count = 0;
+			for ( const FWaitNode* Node = Head.Next; Node != &Head; Node = Node->Next )
+			{
+				++Count;
+			}
+			return Count;
+		}
+
+	private:
+		FWaitNode Head;
+	};
+
+	/**
+	 * @brief 型付きの侵入型待機リスト
+	 * @tparam T FWaitNodeの派生型
+	*/
+	template<class T>
+	struct TWaitList : public FWaitList
+	{
+		T* PopFront() noexcept
+		{
+			return static_cast<T*>(FWaitList::PopFront());
+		}
+	};
+
+	/**
+	 * @brief 待機リストのコルーチンを全て再開する
+	 *
+	 * 再開中に待機の追加・破棄やリスト自体の破棄が行われても安全な様に
+	 * 一旦ローカルのリストに退避してから再開する。
+	 * @param List 待機リスト
+	*/
+	inline void ResumeAll(TWaitList<FCoroutineWaitNode>& List)
+	{
+		TWaitList<FCoroutineWaitNode> Pending;
+		Pending.Append(List);
+		while ( FCoroutineWaitNode* Node = Pending.PopFront() )
+		{
+			Node->Coroutine.resume();
+		}
+	}
+
+} // namespace unco::details
@@ -0,0 +1,80 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+// 条件を満たすまでの待機を記述する
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/Invoke.h"
+#include "UncoScheduler.h"
+#include <coroutine>
+#include <type_traits>
+
+namespace unco
+{
+	namespace details
+	{
+		/**
+		 * @brief 条件を満たすまでの待機
+		 *
+		 * 条件はAwaiter(=コルーチンフレーム)内に保持する為、待機中のヒープ確保は発生しない。
+		*/
+		template<class PredicateType>
+		struct TWaitUntilAwaiter : private FWaitUntilNode
+		{
+			TWaitUntilAwaiter(const UObject* InWorldContext, PredicateType&& InPredicate, int32 InCadence)
+			    : WorldContext(InWorldContext)
+			    , Predicate(MoveTemp(InPredicate))
+			    , Cadence(InCadence)
+			{
+			}
+
+			// 既に満たしている場合は待機しない
+			bool await_ready()
+			{
+				return Invoke(Predicate);
+			}
+			// スケジューラーが無い場合は中断しない
+			bool await_suspend(std::coroutine_handle<> coroutine)
+			{
+				return SuspendUntil(WorldContext.Get(), coroutine, &TWaitUntilAwaiter::EvaluatePredicate, Cadence);
+			}
+			constexpr void await_resume() const noexcept
+			{
+			}
+
+		private:
+			static bool EvaluatePredicate(FWaitUntilNode& Node)
+			{
+				TWaitUntilAwaiter& Self = static_cast<TWaitUntilAwaiter&>(Node);
+				return Invoke(Self.Predicate);
+			}
+
+			FWeakObjectPtr WorldContext;
+			PredicateType  Predicate;
+			int32          Cadence;
+		};
+	} // namespace details
+
+	/**
+	 * @brief 条件を満たすまで待機します
+	 *
+	 * 待機中の条件はスケジューラーがTick毎にまとめて判定し、満たしたものだけを再開します。
+	 * 条件の中でコルーチンの再開・破棄を行わないで下さい。
+	 *
+	 * @code
+	 * // 4Tick毎に判定する
+	 * co_await unco::WaitUntil(this, [this] { return Target != nullptr && Target->IsReady(); }, 4);
+	 * @endcode
+	 * @param WorldContextObject ワールドコンテキスト
+	 * @param Predicate trueを返したら再開する
+	 * @param Cadence 判定を行う間隔(Tick数)
+	 */
+	template<class PredicateType>
+	details::TWaitUntilAwaiter<std::decay_t<PredicateType>> WaitUntil(const UObject*  WorldContextObject,
+	                                                                  PredicateType&& Predicate,
+	                                                                  int32           Cadence = 1)
+	{
+		return details::TWaitUntilAwaiter<std::decay_t<PredicateType>>(
+		    WorldContextObject, std::decay_t<PredicateType>(Forward<PredicateType>(Predicate)), Cadence);
+	}
+
+} // namespace unco
@@ -0,0 +1,69 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+// 長時間の再開の検出を記述する
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UncoTrace.h"
+
+namespace unco
+{
+
+	/**
+	 * @brief 閾値を超えた再開の記録
+	*/
+	struct FLongSliceRecord
+	{
+		// 再開したコルーチン関数名(ジェネレーターの場合は呼び出し元オブジェクト)
+		FString CallSite;
+		// 再開前に待機していたAwaiterの型
+		FString Awaiter;
+		// 再開前に待機していた位置
+		FString File;
+		int32   Line = 0;
+		// 再開からサスペンドまでの時間(ms)
+		float DurationMs = 0.f;
+		// 記録したフレーム
+		uint64 FrameNumber = 0;
+	};
+
+	/**
+	 * @brief 閾値を超えた再開の記録を取得します
+	 *
+	 * 閾値はコンソール変数 unco.SliceWatchdogThresholdMs で設定します(0で無効)。
+	 * 記録はリングバッファに保持され、古いものから上書きされます。
+	 * @return 古い順の記録
+	 */
+	UNREALCOROUTINE_API TArray<FLongSliceRecord> GetLongSlices();
+
+	/**
+	 * @brief 閾値を超えた再開の記録を出力します
+	 * コンソールコマンド unco.DumpLongSlices からも出力出来ます
+	 * @param Ar 出力先
+	 */
+	UNREALCOROUTINE_API void DumpLongSlices(FOutputDevice& Ar);
+
+	/**
+	 * @brief 閾値を超えた再開の記録をCSVに書き出します
+	 * コンソールコマンド unco.WriteLongSlicesCsv からも書き出せます
+	 * @param Filename 出力先のファイルパス
+	 * @return 書き出せたか
+	 */
+	UNREALCOROUTINE_API bool WriteLongSlicesCsv(const FString& Filename);
+
+} // namespace unco
+
+#if UNCO_WATCHDOG_ENABLED
+
+namespace unco::details
+{
+
+	/**
+	 * @brief 閾値を超えたジェネレーターのステップを記録する
+	 * @param HostObject ジェネレーターの呼び出し元オブジェクト
+	 * @param Cycles ステップに掛かった時間
+	*/
+	UNREALCOROUTINE_API void ReportLongGeneratorStep(const UObject* HostObject, uint64 Cycles);
+
+} // namespace unco::details
+
+#endif // UNCO_WATCHDOG_ENABLED
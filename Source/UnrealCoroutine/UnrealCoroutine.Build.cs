@@ -27,5 +27,18 @@ public class UnrealCoroutine : ModuleRules
 			}
 			);
 
+		// ナビゲーション関連の非同期関数(AsyncFindPath)を使用するか
+		// ナビメッシュをビルドしないターゲット(bCompileRecast=false)やプログラムではNavigationSystemに依存しない
+		bool bWithNavigation = Target.bCompileRecast && Target.Type != TargetType.Program;
+		if (bWithNavigation)
+		{
+			PublicDependencyModuleNames.Add("NavigationSystem");
+			PublicDefinitions.Add("UNCO_WITH_NAVIGATION=1");
+		}
+		else
+		{
+			PublicDefinitions.Add("UNCO_WITH_NAVIGATION=0");
+		}
+
 	}
 }